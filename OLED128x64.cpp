@@ -18,438 +18,2919 @@
  */
 
 #include <Wire.h>
+#include <SPI.h>
 #include "OLED128x64.h"
 
+#define OLED_TEMPLATE                template <int W, int H, int XOFF, class BUS>
+#define OLED_CLASS                   SSD1306<W, H, XOFF, BUS>
+
+
+/* Initialization sequence, completed by the geometry dependent multiplex
+ * ratio and COM pins configuration, and by the orientation */
+static const byte initCmds[] PROGMEM = {
+    OLED_OFF,
+    OLED_NORMALDISPLAY,
+    OLED_SETDISPLAYCLOCKDIV,     0x80,
+    OLED_SETDISPLAYOFFSET,       0x00,
+    OLED_STARTLINE | 0x00,
+    OLED_CHARGEPUMP,             0x14,
+    OLED_SETMEMORYMODE,          0x00,
+    OLED_SETCONTRAST,            0xCF,
+    OLED_SETPRECHARGE,           0xF1,
+    OLED_SETVCOMDETECT,          0x40,
+    OLED_DISPLAYALLONRESUME,
+    OLED_SCROLLOFF
+};
+
+
+#ifdef OLED_STATS
+/**
+ * Time a public call for the whole scope it is declared in. Nested public
+ * calls (e.g. display() from drawStr()) are charged to the outermost one.
+ */
+class OLEDStatScope
+{
+    public:
+        OLEDStatScope(OLEDStats &stats, byte &depth, const byte op)
+            : _stats(stats), _depth(depth), _op(op) {
+            if (_depth++ == 0) _start = micros();
+        }
+        ~OLEDStatScope() {
+            if (--_depth == 0) {
+                _stats.calls[_op]++;
+                _stats.micros[_op] += micros() - _start;
+            }
+        }
+
+    private:
+        OLEDStats     &_stats;
+        byte          &_depth;
+        const byte     _op;
+        unsigned long  _start;
+};
+
+#define OLED_STAT_SCOPE(op)       OLEDStatScope _statScope(_stats, _statDepth, op)
+#define OLED_STAT_ADD(field, n)   (_stats.field += (n))
+#else
+#define OLED_STAT_SCOPE(op)
+#define OLED_STAT_ADD(field, n)
+#endif
+
+
+/**
+ * Reverse bytes of an array in place.
+ *
+ * @param  data       Array
+ * @param  i          First index
+ * @param  j          Last index
+ */
+static void reverseBytes(byte *data, int i, int j) {
+    byte t;
+
+    for(; i<j; i++, j--) {
+        t       = data[i];
+        data[i] = data[j];
+        data[j] = t;
+    }
+}
+
+
+/**
+ * Transpose an 8x8 bit matrix (Hacker's Delight, transpose8rS32): three
+ * rounds of masked swaps on two 32 bits words instead of 64 bit tests.
+ * Rows are MSB first (leftmost pixel in bit 7); columns come out LSB on
+ * top, as the display pages expect.
+ *
+ * @param  rows       8 rows, top first
+ * @param  cols       8 columns, leftmost first
+ */
+static void transpose8(const byte *rows, byte *cols) {
+    uint32_t x, y, t;
+
+    /* Rows are loaded bottom first so that the top row lands in the LSB */
+    x = (uint32_t)rows[7] << 24 | (uint32_t)rows[6] << 16 |
+        (uint32_t)rows[5] << 8  | rows[4];
+    y = (uint32_t)rows[3] << 24 | (uint32_t)rows[2] << 16 |
+        (uint32_t)rows[1] << 8  | rows[0];
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA;  x ^= t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;  y ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x ^= t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y ^= t ^ (t << 14);
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+
+    cols[0] = t >> 24; cols[1] = t >> 16; cols[2] = t >> 8; cols[3] = t;
+    cols[4] = y >> 24; cols[5] = y >> 16; cols[6] = y >> 8; cols[7] = y;
+}
+
+
+/**
+ * Format a fixed point number without stdio. Characters are written
+ * backwards from the end of the buffer, then padded with spaces on the
+ * left up to the field width.
+ *
+ * @param  end        Buffer end, room for OLED_NUMBER_LEN chars before it
+ * @param  value      Number scaled by 10^decimals
+ * @param  decimals   Digits after the decimal point [0 to 9]
+ * @param  width      Field width in characters, 0 for no padding
+ * @return            First character of the string
+ */
+static char *formatFixed(char *end, const long value, int decimals,
+                                                              int width) {
+    unsigned long n = (value < 0) ? 0UL - (unsigned long)value : value;
+    char         *p = end;
+
+    if (width > OLED_NUMBER_LEN) width = OLED_NUMBER_LEN;
+
+    *p = 0;
+    do {
+        *--p = '0' + n % 10;
+        n /= 10;
+        if (--decimals == 0) *--p = '.';
+    } while(n || decimals >= 0);
+
+    if (value < 0) *--p = '-';
+    while(end - p < width) *--p = ' ';
+
+    return p;
+}
+
+
+/* 4x4 Bayer matrix, thresholds for ordered dithering */
+static const byte bayer4[4][4] PROGMEM = {
+    {  8, 136,  40, 168},
+    {200,  72, 232, 104},
+    { 56, 184,  24, 152},
+    {248, 120, 216,  88}
+};
+
+
+/* Spinner animation: | / - \ */
+static const byte spinnerFrames[4][8] PROGMEM = {
+    {0x00, 0x00, 0x00, 0x7E, 0x7E, 0x00, 0x00, 0x00},
+    {0x00, 0x60, 0x30, 0x18, 0x0C, 0x06, 0x02, 0x00},
+    {0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00},
+    {0x00, 0x02, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x00}
+};
+
 
 /* ========================= Constructor / Destructor ======================= */
 
 /**
- * Create an OLED128x64 object.
+ * Create an SSD1306 object on the default transport.
  *
  * @param   address[in]    I2C address of the device
  */
-OLED128x64::OLED128x64(const byte address) {
+OLED_TEMPLATE
+OLED_CLASS::SSD1306(const byte address) : SSD1306(BUS()) {
     setAddress(address);
 }
 
 
-/* ============================ Private Functions =========================== */
-
 /**
- * Write byte via I2C.
+ * Create an SSD1306 object on a configured transport, e.g.
+ * OLED128x64SPI screen(OLEDSPI(DC_PIN, CS_PIN)).
  *
- * @param   byte[in]      Byte to write
- * @param   mode[in]      Mode command (OLED_CMD_MODE) or data (OLED_DATA_MODE)
+ * @param   bus[in]        Transport
  */
-void OLED128x64::_write(const byte data, const byte mode) {
-    Wire.beginTransmission(_address);
-    Wire.write(mode);
-    Wire.write(data);
-    Wire.endTransmission();
+OLED_TEMPLATE
+OLED_CLASS::SSD1306(const BUS &bus) : _bus(bus) {
+    int p;
+
+    _buffered  = false;
+    _async     = false;
+    _scrollFrom = PAGES;
+    _scrollTo   = 0;
+    _conRow     = _conCol = _conTop = _conMore = 0;
+    _startTop   = _shownTop = 0;
+    memset(_fields, 0, sizeof(_fields));
+    _nextField  = 0;
+    _onFlushed = NULL;
+    _rotation   = OLED_ROTATE_0;
+    _mirrorX    = _mirrorY = false;
+    _width      = W;
+    _height     = H;
+    _pages      = PAGES;
+    _xoff       = XOFF;
+    memset(_buffer, 0, sizeof(_buffer));
+#ifdef OLED_DOUBLE_BUFFER
+    memset(_front, 0, sizeof(_front));
+    memset(_stale, 0, sizeof(_stale));
+#endif
+
+    for(p=0; p<MAXPAGES; p++) {
+        _dirtyFrom[p] = _pendingFrom[p] = W;
+        _dirtyTo[p]   = _pendingTo[p]   = 0;
+    }
+
+#ifdef OLED_STATS
+    _statDepth = 0;
+    resetStats();
+#endif
 }
 
 
+/* ============================ Fonts ======================================= */
+
 /**
- * Clear screen buffer.
+ * Decode the next character of a UTF-8 string. Malformed sequences and
+ * code points beyond 16 bits decode as U+FFFD, drawn with the fallback
+ * glyph of the font.
+ *
+ * @param  string     String, moved past the character
+ * @return character code
  */
-void OLED128x64::_clearBuffer() {
-    int i,j;
-    for(i=0; i<OLED_WIDTH; i++) {
-        for(j=0; j<OLED_HEIGHT/8; j++) {
-            _buffer[i][j] = 0;
+static uint16_t utf8Next(const char **string) {
+    const byte *s = (const byte *)*string;
+    uint32_t    c = *s++;
+    int         n;
+
+    if (c < 0x80)       n = 0;
+    else if (c >= 0xF0) { n = 3; c &= 0x07; }
+    else if (c >= 0xE0) { n = 2; c &= 0x0F; }
+    else if (c >= 0xC0) { n = 1; c &= 0x1F; }
+    else                { n = 0; c = 0xFFFD; }
+
+    for(; n>0; n--) {
+        if ((*s & 0xC0) != 0x80) {
+            c = 0xFFFD;
+            break;
         }
+        c = (c << 6) | (*s++ & 0x3F);
     }
+
+    *string = (const char *)s;
+    return (c > 0xFFFF) ? 0xFFFD : c;
 }
 
 
 /**
- * Clear screen.
+ * Find the glyph index of a character. Ranges are sorted, so a binary
+ * search finds it in a few steps whatever the number of ranges.
+ *
+ * @param  c          Character code
+ * @return glyph index, the fallback glyph if the font lacks the character
  */
-void OLED128x64::_clearScreen() {
-    int i,j;
-
-    for(j=0; j<OLED_HEIGHT/8; j++) {
-      setCharCursor(j,0);
-      for(i=0; i<OLED_WIDTH; i++) {
-          _write(0, OLED_DATA_MODE);
-      }
+uint16_t OLEDFont::index(const uint16_t c) const {
+    int lo = 0, hi = rangeCount - 1, mid;
+
+    while (lo <= hi) {
+        mid = (lo + hi) / 2;
+        if (c < pgm_read_word(&ranges[mid].first)) {
+            hi = mid - 1;
+        } else if (c > pgm_read_word(&ranges[mid].last)) {
+            lo = mid + 1;
+        } else {
+            return pgm_read_word(&ranges[mid].offset) + c -
+                   pgm_read_word(&ranges[mid].first);
+        }
     }
-
-    setCharCursor(0,0);
+    return fallback;
 }
 
 
 /**
- * Clear character in buffer.
+ * Find the glyph of a character.
  *
- * @param  X      Character row [0 to 7]
- * @param  Y      Character column [0 to 15]
+ * @param  c          Character code
+ * @return glyph bytes (PROGMEM), columns of each page in turn
  */
-void OLED128x64::_clearCharBuffer(const int X, const int Y) {
-    int i;
-
-    for(i=0; i<8; i++) {
-        _buffer[Y*8+i][X] = 0;
-    }
+const byte *OLEDFont::glyph(const uint16_t c) const {
+    return glyphs + index(c) * width * (height / 8);
 }
 
 
 /**
- * Clear character on screen.
+ * Horizontal advance of a character.
  *
- * @param  X      Character row [0 to 7]
- * @param  Y      Character column [0 to 15]
+ * @param  c          Character code
+ * @return advance in pixels
  */
-void OLED128x64::_clearCharScreen(const int X, const int Y) {
-    int i;
+byte OLEDFont::advance(const uint16_t c) const {
+    return widths ? pgm_read_byte(widths + index(c)) : width;
+}
 
-    setCharCursor(X, Y);
 
-    for(i=0; i<8; i++) {
-        _write(0x00, OLED_DATA_MODE);
+/**
+ * Width of a string once drawn with drawText().
+ *
+ * @param  string     UTF-8 string to measure
+ * @return width in pixels
+ */
+int OLEDFont::textWidth(const char *string) const {
+    int w = 0;
+
+    while (*string) {
+        w += advance(utf8Next(&string));
     }
+    return w;
 }
 
 
-/* ============================ Getters / Setters =========================== */
+/* ============================ I2C transport =============================== */
 
 /**
- * Get address byte.
+ * Constructor, using the default Wire interface.
  *
- * @return  byte containing the I2C address of the device
+ * @param  address    I2C address of the device
  */
-byte OLED128x64::getAddress() {
-    return _address;
+OLEDI2C::OLEDI2C(const byte address) {
+    _wire       = &Wire;
+    _dma        = NULL;
+    _dmaContext = NULL;
+    _address    = address;
+    _len        = 0;
+#ifdef OLED_STATS
+    transactions = 0;
+#endif
 }
 
 
 /**
- * Set address byte.
+ * Constructor, for boards with several I2C interfaces.
  *
- * @param  address  Byte containing the I2C address of the device
+ * @param  address    I2C address of the device
+ * @param  wire       Interface the device is wired to
  */
-void OLED128x64::setAddress(const byte address) {
+OLEDI2C::OLEDI2C(const byte address, TwoWire &wire) {
+    _wire       = &wire;
+    _dma        = NULL;
+    _dmaContext = NULL;
+    _address    = address;
+    _len        = 0;
+#ifdef OLED_STATS
+    transactions = 0;
+#endif
+}
+
+
+void OLEDI2C::setAddress(const byte address) {
     _address = address;
 }
 
 
+byte OLEDI2C::getAddress() {
+    return _address;
+}
+
+
 /**
- * Set/unset inverted display mode.
- *
- * @param  val  If true inverted mode is enabled
+ * Identify the bus, shared by every device on the same Wire instance.
  */
-void OLED128x64::setInvertedDisplay(const bool val) {
-    if (val) {
-        _write(OLED_INVERTDISPLAY, OLED_CMD_MODE);
-    } else {
-        _write(OLED_NORMALDISPLAY, OLED_CMD_MODE);
-    }
+const void *OLEDI2C::getPort() {
+    return _wire;
 }
 
 
 /**
- * Set/unset a pixel.
+ * Hand complete transmissions (control byte first) to a hook instead of
+ * the Wire interface.
  *
- * @param  row     Pixel row [0 to 63]
- * @param  col     Pixel column [0 to 127]
- * @param  val     If true, show pixel
+ * @param  hook       Hook, NULL to use the Wire interface
+ * @param  context    Passed back to the hook
  */
-void OLED128x64::setPixel(const int row, const int col, const bool val) {
-    _buffer[col][row/8] |= (val << (row%8));
+void OLEDI2C::setDmaHook(OLEDDmaHook hook, void *context) {
+    _dma        = hook;
+    _dmaContext = context;
+}
+
 
-    _write(0xB0 + row/8,                              OLED_CMD_MODE);
-    _write(OLED_LOWCOLUMN + (col & 0x0F),             OLED_CMD_MODE);
-    _write(OLED_HIGHCOLUMN + ((col>>4) & 0x0F),       OLED_CMD_MODE);
-    _write(_buffer[col][row/8],                       OLED_DATA_MODE);
+/**
+ * Nothing to set up: the sketch starts the Wire interface.
+ */
+void OLEDI2C::begin() {
 }
 
 
 /**
- * Set cursor position for 8x8 pixels char.
+ * Start a stream of bytes sharing the same control byte.
  *
- * @param  X      Character row [0 to 7]
- * @param  Y      Character column [0 to 15]
+ * @param  mode       Control byte (OLED_DATA_MODE or OLED_CMD_STREAM)
  */
-void OLED128x64::setCharCursor(const int X, const int Y) {
-  _write(0xB0 + X,                                    OLED_CMD_MODE);
-  _write(OLED_LOWCOLUMN + (8*Y & 0x0F),               OLED_CMD_MODE);
-  _write(OLED_HIGHCOLUMN + ((8*Y>>4) & 0x0F),         OLED_CMD_MODE);
+void OLEDI2C::beginStream(const byte mode) {
+    _buf[0] = mode;
+    _len    = 1;
 }
 
 
 /**
- * Set cursor position.
+ * Append a byte to the current stream, sending the pending transmission
+ * first when it is full.
  *
- * @param  X       Row [0 to 7]
- * @param  col     Pixel column [0 to 127]
+ * @param  data       Byte to write
  */
-void OLED128x64::setCursor(const int X, const int col) {
-  _write(0xB0 + X,                                    OLED_CMD_MODE);
-  _write(OLED_LOWCOLUMN + (col & 0x0F),               OLED_CMD_MODE);
-  _write(OLED_HIGHCOLUMN + ((col>>4) & 0x0F),         OLED_CMD_MODE);
+void OLEDI2C::write(const byte data) {
+    if (_len == OLED_I2C_BUFFER) {
+        _send();
+    }
+    _buf[_len++] = data;
 }
 
 
-/* ============================ Public Functions ============================ */
-
 /**
- * Initialize sceen with default settings
+ * Append bytes to the current stream, filling transmissions with bulk
+ * copies.
+ *
+ * @param  data       Bytes to write
+ * @param  len        Number of bytes
  */
-void OLED128x64::init() {
-    _write(OLED_OFF,                             OLED_CMD_MODE);
-    _write(OLED_NORMALDISPLAY,                   OLED_CMD_MODE);
+void OLEDI2C::write(const byte *data, int len) {
+    int n;
 
-    _write(OLED_SETDISPLAYCLOCKDIV,              OLED_CMD_MODE);
-    _write(0x80,                                 OLED_CMD_MODE);
+    while (len > 0) {
+        if (_len == OLED_I2C_BUFFER) {
+            _send();
+        }
+        n = OLED_I2C_BUFFER - _len;
+        if (n > len) n = len;
 
-    _write(OLED_SETMULTIPLEX,                    OLED_CMD_MODE);
-    _write(0x3F,                                 OLED_CMD_MODE);
+        memcpy(&_buf[_len], data, n);
+        _len += n;
+        data += n;
+        len  -= n;
+    }
+}
 
-    _write(OLED_SETDISPLAYOFFSET,                OLED_CMD_MODE);
-    _write(0x00,                                 OLED_CMD_MODE);
 
-    _write(OLED_STARTLINE | 0x00,                OLED_CMD_MODE);
+/**
+ * Close the current stream and send remaining bytes.
+ */
+void OLEDI2C::endStream() {
+    if (_len > 1) {
+        _send();
+    }
+}
 
-    _write(OLED_CHARGEPUMP,                      OLED_CMD_MODE);
-    _write(0x14,                                 OLED_CMD_MODE);
 
-    _write(OLED_SETMEMORYMODE,                   OLED_CMD_MODE);
-    _write(0x00,                                 OLED_CMD_MODE);
+/**
+ * Send the pending transmission. The control byte is kept for the next
+ * one.
+ */
+void OLEDI2C::_send() {
+    if (_dma) {
+        _dma(_dmaContext, _address, _buf, _len);
+    } else {
+        _wire->beginTransmission(_address);
+        _wire->write(_buf, _len);
+        _wire->endTransmission();
+    }
+    _len = 1;
+#ifdef OLED_STATS
+    transactions++;
+#endif
+}
 
-    _write(OLED_SEGREMAP,                        OLED_CMD_MODE);
 
-    _write(OLED_COMSCANDEC,                      OLED_CMD_MODE);
+/* ============================ SPI transport =============================== */
 
-    _write(OLED_SETCOMPINS,                      OLED_CMD_MODE);
-    _write(0x12,                                 OLED_CMD_MODE);
+/**
+ * Constructor.
+ *
+ * @param  dc         Data/command pin
+ * @param  cs         Chip select pin, OLED_NO_PIN if tied low
+ * @param  clock      SPI clock in Hz
+ */
+OLEDSPI::OLEDSPI(const byte dc, const byte cs, const unsigned long clock) {
+    _dma        = NULL;
+    _dmaContext = NULL;
+    _clock      = clock;
+    _dc         = dc;
+    _cs         = cs;
+#ifdef OLED_STATS
+    transactions = 0;
+#endif
+}
 
-    _write(OLED_SETCONTRAST,                     OLED_CMD_MODE);
-    _write(0xCF,                                 OLED_CMD_MODE);
 
-    _write(OLED_SETPRECHARGE,                    OLED_CMD_MODE);
-    _write(0xF1,                                 OLED_CMD_MODE);
+/**
+ * SPI devices have no address.
+ */
+void OLEDSPI::setAddress(const byte) {
+}
 
-    _write(OLED_SETVCOMDETECT,                   OLED_CMD_MODE);
-    _write(0x40,                                 OLED_CMD_MODE);
 
-    _write(OLED_DISPLAYALLONRESUME,              OLED_CMD_MODE);
+byte OLEDSPI::getAddress() {
+    return 0;
+}
 
-    _write(OLED_SEGREMAP,                        OLED_CMD_MODE);
-    _write(0xa1,                                 OLED_CMD_MODE);
 
-    _write(OLED_SCROLLOFF,                       OLED_CMD_MODE);
+/**
+ * Identify the bus, shared by every device on hardware SPI.
+ */
+const void *OLEDSPI::getPort() {
+    return &SPI;
+}
 
-    clear();
-    powerOn();
+
+/**
+ * Hand bulk writes to a hook (e.g. a DMA transfer) instead of sending
+ * them byte per byte. The hook is called with CS and D/C already set and
+ * must wait for the transfer to end, CS is raised when the stream closes.
+ *
+ * @param  hook       Hook, NULL to use SPI.transfer()
+ * @param  context    Passed back to the hook
+ */
+void OLEDSPI::setDmaHook(OLEDDmaHook hook, void *context) {
+    _dma        = hook;
+    _dmaContext = context;
 }
 
 
 /**
- * Clear all displayed data and buffer.
+ * Configure the pins and start the SPI interface.
  */
-void OLED128x64::clear() {
-    _clearScreen();
-    _clearBuffer();
-    setCharCursor(0,0);
+void OLEDSPI::begin() {
+    pinMode(_dc, OUTPUT);
+    if (_cs != OLED_NO_PIN) {
+        pinMode(_cs, OUTPUT);
+        digitalWrite(_cs, HIGH);
+    }
+    SPI.begin();
 }
 
 
 /**
- * Clear character on screen and in buffer.
+ * Start a stream of commands or data.
  *
- * @param  X      Character row [0 to 7]
- * @param  Y      Character column [0 to 15]
+ * @param  mode       OLED_DATA_MODE or OLED_CMD_STREAM
  */
-void OLED128x64::clearChar(const int X, const int Y) {
-    _clearCharBuffer(X, Y);
-    _clearCharScreen(X, Y);
-    setCharCursor(0,0);
+void OLEDSPI::beginStream(const byte mode) {
+    digitalWrite(_dc, (mode == OLED_DATA_MODE) ? HIGH : LOW);
+    SPI.beginTransaction(SPISettings(_clock, MSBFIRST, SPI_MODE0));
+    if (_cs != OLED_NO_PIN) {
+        digitalWrite(_cs, LOW);
+    }
+}
+
+
+void OLEDSPI::write(const byte data) {
+    SPI.transfer(data);
 }
 
 
 /**
- * Clear character row on screen and in buffer.
+ * Append bytes to the current stream. SPI.transfer(buf, len) is not used
+ * as it overwrites the buffer with the received bytes.
  *
- * @param  X      Character row [0 to 7]
+ * @param  data       Bytes to write
+ * @param  len        Number of bytes
  */
-void OLED128x64::clearCharRow(const int X) {
-    int j;
+void OLEDSPI::write(const byte *data, int len) {
+    int i;
 
-    for (j=0; j<OLED_WIDTH/8; j++) {
-        _clearCharBuffer(X, j);
-        _clearCharScreen(X, j);
+    if (_dma) {
+        _dma(_dmaContext, 0, data, len);
+        return;
+    }
+    for(i=0; i<len; i++) {
+        SPI.transfer(data[i]);
     }
-    setCharCursor(0,0);
 }
 
 
 /**
- * Power off the screen to save power.
+ * Close the current stream.
  */
-void OLED128x64::powerOn() {
-    _write(OLED_ON, OLED_CMD_MODE);
+void OLEDSPI::endStream() {
+    if (_cs != OLED_NO_PIN) {
+        digitalWrite(_cs, HIGH);
+    }
+    SPI.endTransaction();
+#ifdef OLED_STATS
+    transactions++;
+#endif
+}
+
+
+/* ============================ Display manager ============================= */
+
+OLEDManager::OLEDManager() {
+    _count = 0;
+    _next  = 0;
 }
 
 
 /**
- * Power on the screen.
+ * Hand a display over to the manager. The display is switched to
+ * asynchronous mode: its frames are queued and sent by poll().
+ *
+ * @param  screen     Display to manage
+ * @return false when OLED_MAX_SCREENS displays are already managed
  */
-void OLED128x64::powerOff() {
-    _write(OLED_OFF, OLED_CMD_MODE);
+bool OLEDManager::add(OLEDScreen &screen) {
+    if (_count == OLED_MAX_SCREENS) return false;
+
+    screen.setAsync(true);
+    _screens[_count++] = &screen;
+    return true;
 }
 
 
 /**
- * Draw a progress bar.
- *
- * @param  X              Character row [0 to 7]
- * @param  percent        Percentage
+ * Queue the modified areas of every display (see display() of each driver).
  */
-void OLED128x64::drawProgressBar(const int X, const int percent) {
+void OLEDManager::display() {
     int i;
 
-    /* Clean row */
-    if(percent == 0) {
-        clearCharRow(X);
+    for(i=0; i<_count; i++) {
+        _screens[i]->display();
+    }
+}
+
+
+/**
+ * Send part of the queued areas of every display. Each bus gets its own
+ * budget, first split evenly between the displays it still has to feed,
+ * then what they leave goes to the others in turn. The display served
+ * first changes at each call so rounding never favours the same one.
+ *
+ * @param  budget     Maximum number of data bytes sent on each bus
+ * @return true while a display still has a frame in flight
+ */
+bool OLEDManager::poll(const int budget) {
+    const void *ports[OLED_MAX_SCREENS];
+    int         left[OLED_MAX_SCREENS];
+    byte        active[OLED_MAX_SCREENS];
+    byte        bus[OLED_MAX_SCREENS];
+    int         buses = 0, pass, i, j, k, share;
+
+    /* Group displays by bus */
+    for(i=0; i<_count; i++) {
+        const void *port = _screens[i]->getPort();
+
+        for(j=0; j<buses && ports[j] != port; j++);
+        if (j == buses) {
+            ports[j]  = port;
+            left[j]   = budget;
+            active[j] = 0;
+            buses++;
+        }
+        bus[i] = j;
+        if (_screens[i]->isFlushing()) active[j]++;
     }
 
-    /* Draw Layout */
-    setCursor(X, 12);
-    _write(0x7E, OLED_DATA_MODE);
-    setCursor(X, 113);
-    _write(0x7E, OLED_DATA_MODE);
+    for(pass=0; pass<2; pass++) {
+        for(k=0; k<_count; k++) {
+            i = (_next + k) % _count;
+            j = bus[i];
+            if (left[j] <= 0 || !_screens[i]->isFlushing()) continue;
 
-    /* Draw Progress Bar */
-    setCursor(X, 13);
-    for(i=0;i<100;i++) {
-        if (percent >= i) {
-            _write(0x7E, OLED_DATA_MODE);
-        } else {
-            _write(0x42, OLED_DATA_MODE);
+            share = pass ? left[j] : (budget + active[j] - 1) / active[j];
+            if (share > left[j]) share = left[j];
+            left[j] -= _screens[i]->flushBudget(share);
         }
     }
+
+    if (_count) {
+        _next = (_next + 1) % _count;
+    }
+    return isFlushing();
 }
 
 
 /**
- * Draw string of char using default font.
+ * Check whether a display still has a frame in flight.
  *
- * @param  string         String to draw
- * @param  X              Start row [0 to 7]
- * @param  Y              Start column [0 to 15]
+ * @return  true if queued areas remain
  */
-void OLED128x64::drawStr(const char *string, const int X, const int Y) {
-    drawStr(string, X, Y, defaultFont);
+bool OLEDManager::isFlushing() {
+    int i;
+
+    for(i=0; i<_count; i++) {
+        if (_screens[i]->isFlushing()) return true;
+    }
+    return false;
 }
 
 
+/* ============================ Private Functions =========================== */
+
 /**
- * Draw string of char using a provided font.
+ * Start a stream of bytes sharing the same control byte. The transport
+ * splits it into as many transactions as it requires. Must be closed with
+ * _endStream().
  *
- * @param  string         String to draw
- * @param  X              Start row [0 to 7]
- * @param  Y              Start column [0 to 15]
- * @param  font           Font to use
+ * @param   mode[in]      Control byte (OLED_DATA_MODE or OLED_CMD_STREAM)
  */
-void OLED128x64::drawStr(const char *string, const int X, const int Y,
-                                                      const char font[256][8]) {
-    setCharCursor(X,Y);
-    char i=0;
+OLED_TEMPLATE
+void OLED_CLASS::_beginStream(const byte mode) {
+    _bus.beginStream(mode);
+}
 
-    while(*string) {
-        for(i=0;i<8;i++) {
-            _write(pgm_read_byte(font[(unsigned char)*string]+i),
-                                                                OLED_DATA_MODE);
-        }
-        *string++;
+
+/**
+ * Append a command byte to the current stream.
+ *
+ * @param   data[in]      Byte to write
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_stream(const byte data) {
+    _bus.write(data);
+    OLED_STAT_ADD(cmdBytes, 1);
+}
+
+
+/**
+ * Append a run of data bytes to the current stream with a bulk write.
+ *
+ * @param   data[in]      Bytes to write
+ * @param   len[in]       Number of bytes
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_streamBuf(const byte *data, const int len) {
+    _bus.write(data, len);
+    OLED_STAT_ADD(dataBytes, len);
+}
+
+
+/**
+ * Close the current stream and send remaining bytes.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_endStream() {
+    _bus.endStream();
+}
+
+
+/**
+ * Append bytes stored in flash to the current stream.
+ *
+ * @param   data[in]      Bytes to write (PROGMEM)
+ * @param   len[in]       Number of bytes
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_streamP(const byte *data, const int len) {
+    int i;
+
+    for(i=0; i<len; i++) {
+        _stream(pgm_read_byte(data + i));
     }
 }
 
 
 /**
- * Draw an image.
+ * Clear screen buffer. Only the span of non-blank columns of each page is
+ * marked as modified.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_clearBuffer() {
+    int p, from, to;
+
+    for(p=0; p<_pages; p++) {
+        for(from=0; from<_width && !_page(p)[from]; from++);
+        if (from == _width) continue;
+        for(to=_width-1; !_page(p)[to]; to--);
+
+        memset(_page(p) + from, 0, to - from + 1);
+        _markDirty(p, p, from, to);
+    }
+}
+
+
+/**
+ * Clear character in buffer.
  *
- * @param  data         Image to draw
+ * @param  X      Character row [0 to 7]
+ * @param  Y      Character column [0 to 15]
  */
-void OLED128x64::drawImage(const char *data){
+OLED_TEMPLATE
+void OLED_CLASS::_clearCharBuffer(const int X, const int Y) {
     int i;
 
-    clear();
-    setCharCursor(0,0);
-    for(int i=0; i<OLED_WIDTH*OLED_HEIGHT/8;i++) {
-        _write(pgm_read_byte(data + i), OLED_DATA_MODE);
+    if (X < 0 || X >= _pages || Y < 0 || 8*Y + 8 > _width) return;
+    for(i=0; i<8; i++) {
+        _putByte(X, Y*8+i, 0);
     }
 }
 
 
 /**
- * Draw a horizontal line.
+ * Record a modified area of the buffer, to be sent by the next display().
  *
- * @param  row         Row where the line has to be drawn
+ * @param  page0      First page [0 to 7]
+ * @param  page1      Last page [0 to 7]
+ * @param  col0       First column [0 to 127]
+ * @param  col1       Last column [0 to 127]
  */
-void OLED128x64::drawHLine(const int row){
-    char i;
-    setCharCursor(row/8,0);
-    unsigned char value = 0;
-    value |= (1 << (row%8));
-    for(i=0;i<128;i++) {
-        _write(value, OLED_DATA_MODE);
+OLED_TEMPLATE
+void OLED_CLASS::_markDirty(const int page0, const int page1,
+                            const int col0, const int col1) {
+    int p;
+
+    for(p=page0; p<=page1; p++) {
+        if (col0 < _dirtyFrom[p]) _dirtyFrom[p] = col0;
+        if (col1 > _dirtyTo[p])   _dirtyTo[p]   = col1;
     }
-    setCharCursor(0,0);
 }
 
 
 /**
- * Draw a vertical line.
+ * Get a page of the buffer. The buffer holds _pages pages of _width bytes,
+ * so its layout follows the rotation. The stride is one of two constants
+ * rather than _width, so landscape indexing stays a constant multiply.
  *
- * @param  col         Column where the line has to be drawn
+ * @param  page       Page [0 to _pages-1]
+ * @return first byte of the page
+ */
+OLED_TEMPLATE
+byte *OLED_CLASS::_page(const int page) {
+    return &_buffer[page * ((_rotation & 1) ? H : W)];
+}
+
+
+/**
+ * Get a page as it is sent to the screen: from the front buffer in double
+ * buffered mode, so drawing the next frame never shows up half done.
+ *
+ * @param  page       Page [0 to _pages-1]
+ * @return first byte of the page
+ */
+OLED_TEMPLATE
+byte *OLED_CLASS::_frontPage(const int page) {
+#ifdef OLED_DOUBLE_BUFFER
+    return &_front[page * ((_rotation & 1) ? H : W)];
+#else
+    return _page(page);
+#endif
+}
+
+
+#ifdef OLED_DOUBLE_BUFFER
+/**
+ * Narrow the modified span of a page to the bytes that differ from the
+ * front buffer, then copy them there. Both ends are searched 32 bits at a
+ * time, then byte by byte. An unchanged page gets an empty span. A page
+ * whose screen content was lost (see _invalidate()) is sent whole.
+ *
+ * @param  page       Page [0 to _pages-1]
  */
-void OLED128x64::drawVLine(const int col){
-    char i,k;
-    for(k=0; k<8; k++) {
-      setCursor(k,col);
-      _write(0xFF, OLED_DATA_MODE);
+OLED_TEMPLATE
+void OLED_CLASS::_diffPage(const int page) {
+    const byte *back  = _page(page);
+    byte       *front = _frontPage(page);
+    int         from  = _dirtyFrom[page], to = _dirtyTo[page];
+    uint32_t    a, b;
+
+    if (_stale[page]) {
+        _stale[page]     = false;
+        _dirtyFrom[page] = 0;
+        _dirtyTo[page]   = _width - 1;
+        memcpy(front, back, _width);
+        return;
     }
-    setCharCursor(0,0);
+
+    for(; from + 3 <= to; from += 4) {
+        memcpy(&a, back + from, 4);
+        memcpy(&b, front + from, 4);
+        if (a != b) break;
+    }
+    for(; from <= to && back[from] == front[from]; from++);
+
+    if (from > to) {
+        _dirtyFrom[page] = _width;
+        _dirtyTo[page]   = 0;
+        return;
+    }
+
+    for(; to - 3 >= from; to -= 4) {
+        memcpy(&a, back + to - 3, 4);
+        memcpy(&b, front + to - 3, 4);
+        if (a != b) break;
+    }
+    for(; back[to] == front[to]; to--);
+
+    memcpy(front + from, back + from, to - from + 1);
+    _dirtyFrom[page] = from;
+    _dirtyTo[page]   = to;
 }
+#endif
 
 
-OLED128x64 OLED;
+/**
+ * Mark pages to be sent again even where the buffer did not change, when
+ * the screen content is lost (power-up, scrolling, new orientation).
+ *
+ * @param  page0      First page
+ * @param  page1      Last page
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_invalidate(const int page0, const int page1) {
+#ifdef OLED_DOUBLE_BUFFER
+    int p;
+
+    /* The front buffer no longer tells what the screen shows */
+    for(p=page0; p<=page1; p++) {
+        _stale[p] = true;
+    }
+#endif
+    _markDirty(page0, page1, 0, _width - 1);
+}
 
 
-/* Default font: Quadrang */
-const char defaultFont[][8] PROGMEM = {
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
+/**
+ * Store a byte in the buffer and mark it as modified if it changed, so
+ * redrawing unchanged content costs no bus traffic.
+ *
+ * @param  page       Page [0 to 7]
+ * @param  col        Column [0 to 127]
+ * @param  value      Byte holding 8 vertical pixels (LSB on top)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_putByte(const int page, const int col, const byte value) {
+    if (_page(page)[col] == value) return;
+
+    _page(page)[col] = value;
+    _markDirty(page, page, col, col);
+}
+
+
+/**
+ * Send queued areas of the buffer. Consecutive pages with the same columns
+ * are sent as a single rectangle using the column/page address window. A
+ * page that does not fit in the budget is sent partially.
+ *
+ * @param  budget     Maximum number of data bytes to send
+ * @return number of data bytes sent
+ */
+OLED_TEMPLATE
+int OLED_CLASS::_flush(int budget) {
+    int p, q, i, width, sent = 0;
+    byte from, to;
+
+    if (_rotation & 1) {
+        return _flushRotated(budget);
+    }
+
+    for(p=0; p<PAGES && budget > 0; p=q) {
+        from = _pendingFrom[p];
+        to   = _pendingTo[p];
+        q    = p+1;
+
+        if (from > to) continue;
+
+        width = to - from + 1;
+        if (width > budget) {
+            to    = from + budget - 1;
+            width = budget;
+        } else {
+            while (q<PAGES && (q-p+1)*width <= budget &&
+                   _pendingFrom[q] == from && _pendingTo[q] == to) {
+                q++;
+            }
+        }
+
+        _beginStream(OLED_CMD_STREAM);
+        _stream(OLED_SETCOLUMNADDR);
+        _stream(_xoff + from);
+        _stream(_xoff + to);
+        _stream(OLED_SETPAGEADDR);
+        _stream(p);
+        _stream(q-1);
+        _endStream();
+
+        _beginStream(OLED_DATA_MODE);
+        for(i=p; i<q; i++) {
+            _streamBuf(_frontPage(i) + from, width);
+
+            if (to == _pendingTo[i]) {
+                _pendingFrom[i] = _width;
+                _pendingTo[i]   = 0;
+            } else {
+                _pendingFrom[i] = to + 1;
+            }
+        }
+        _endStream();
+
+        budget -= width*(q-p);
+        sent   += width*(q-p);
+    }
+
+    _flushStartLine();
+    if (sent && _onFlushed && !isFlushing()) {
+        _onFlushed();
+    }
+    return sent;
+}
+
+
+/**
+ * Send queued areas in portrait orientation. A page of the buffer is a
+ * band of 8 physical columns: its queued columns are read as 8x8 blocks,
+ * transposed and sent as a single window, one block per physical page.
+ * The budget is rounded down to whole blocks, at least one is sent.
+ *
+ * @param  budget     Maximum number of data bytes to send
+ * @return number of data bytes sent
+ */
+OLED_TEMPLATE
+int OLED_CLASS::_flushRotated(int budget) {
+    const bool cw = (_rotation == OLED_ROTATE_90);
+    byte rows[8], cols[8];
+    int  p, i, j, k, first, last, n, col, sent = 0;
+
+    for(p=0; p<_pages && budget > 0; p++) {
+        if (_pendingFrom[p] > _pendingTo[p]) continue;
+
+        /* Blocks of 8 buffer columns, one per physical page. At 90 degrees
+         * buffer columns run down the panel and pages from its right edge,
+         * at 270 degrees up the panel and from its left edge. */
+        first = _pendingFrom[p] >> 3;
+        last  = _pendingTo[p] >> 3;
+        n     = last - first + 1;
+        if (8*n > budget) {
+            n = (budget > 8) ? budget/8 : 1;
+            if (cw) last = first + n - 1; else first = last - n + 1;
+        }
+        col = cw ? W - 8 - 8*p : 8*p;
+
+        _beginStream(OLED_CMD_STREAM);
+        _stream(OLED_SETCOLUMNADDR);
+        _stream(_xoff + col);
+        _stream(_xoff + col + 7);
+        _stream(OLED_SETPAGEADDR);
+        _stream(cw ? first : PAGES - 1 - last);
+        _stream(cw ? last : PAGES - 1 - first);
+        _endStream();
+
+        _beginStream(OLED_DATA_MODE);
+        for(i=0; i<n; i++) {
+            k = cw ? first + i : last - i;
+            for(j=0; j<8; j++) {
+                rows[j] = _frontPage(p)[8*k + (cw ? j : 7 - j)];
+            }
+            transpose8(rows, cols);
+            if (!cw) {
+                reverseBytes(cols, 0, 7);
+            }
+            _streamBuf(cols, 8);
+        }
+        _endStream();
+
+        if (cw ? 8*last + 7 >= _pendingTo[p] : 8*first <= _pendingFrom[p]) {
+            _pendingFrom[p] = _width;
+            _pendingTo[p]   = 0;
+        } else if (cw) {
+            _pendingFrom[p] = 8*(last + 1);
+        } else {
+            _pendingTo[p]   = 8*first - 1;
+        }
+
+        budget -= 8*n;
+        sent   += 8*n;
+    }
+
+    _flushStartLine();
+    if (sent && _onFlushed && !isFlushing()) {
+        _onFlushed();
+    }
+    return sent;
+}
+
+
+/**
+ * Stream the segment remap and COM scan direction matching the rotation
+ * and mirroring. Without segment remap GDDRAM columns are read the other
+ * way round, so the window of narrow panels moves to the other end.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_streamOrientation() {
+    bool flipX = (_rotation == OLED_ROTATE_180);
+    bool flipY = flipX;
+
+    if (_rotation & 1) {
+        flipX ^= _mirrorY;
+        flipY ^= _mirrorX;
+    } else {
+        flipX ^= _mirrorX;
+        flipY ^= _mirrorY;
+    }
+
+    _xoff = flipX ? 128 - W - XOFF : XOFF;
+    _stream(OLED_SEGREMAP | (flipX ? 0x00 : 0x01));
+    _stream(flipY ? OLED_COMSCANINC : OLED_COMSCANDEC);
+}
+
+
+/**
+ * Forget queued areas and mark the whole frame to be sent again, after a
+ * change of orientation.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_resetFrame() {
+    int p;
+
+    for(p=0; p<MAXPAGES; p++) {
+        _dirtyFrom[p] = _pendingFrom[p] = _width;
+        _dirtyTo[p]   = _pendingTo[p]   = 0;
+    }
+    _invalidate(0, _pages - 1);
+}
+
+
+/**
+ * Move the hardware start line to the console top queued by display(),
+ * once the pages of that frame are sent, so the scroll shows with the rest
+ * of the frame instead of ahead of it.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_flushStartLine() {
+    int p;
+
+    if (_shownTop == _startTop) return;
+    for(p=0; p<_pages; p++) {
+        if (_pendingFrom[p] <= _pendingTo[p]) return;
+    }
+
+    _beginStream(OLED_CMD_STREAM);
+    _stream(OLED_STARTLINE | (8*_startTop));
+    _endStream();
+    _shownTop = _startTop;
+}
+
+
+/**
+ * Apply a color to the pixels of a buffer byte selected by a mask.
+ *
+ * @param  page       Page [0 to PAGES-1]
+ * @param  col        Column [0 to W-1]
+ * @param  mask       Pixels to modify
+ * @param  color      OLED_WHITE, OLED_BLACK or OLED_INVERSE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_applyMask(const int page, const int col, const byte mask,
+                            const byte color) {
+    const byte b = _page(page)[col];
+
+    switch (color) {
+        case OLED_WHITE:   _putByte(page, col, b |  mask);  break;
+        case OLED_BLACK:   _putByte(page, col, b & ~mask);  break;
+        default:           _putByte(page, col, b ^  mask);  break;
+    }
+}
+
+
+/**
+ * Set one pixel, ignoring pixels outside of the screen.
+ *
+ * @param  x          Column
+ * @param  y          Row
+ * @param  color      OLED_WHITE, OLED_BLACK or OLED_INVERSE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_plot(const int x, const int y, const byte color) {
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return;
+
+    _applyMask(y/8, x, 1 << (y&7), color);
+}
+
+
+/**
+ * Fill a rectangle, clipped to the screen. Each page is filled column by
+ * column with a single byte mask.
+ *
+ * @param  x0         First column
+ * @param  y0         First row
+ * @param  x1         Last column
+ * @param  y1         Last row
+ * @param  color      OLED_WHITE, OLED_BLACK or OLED_INVERSE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_fill(int x0, int y0, int x1, int y1, const byte color) {
+    int  p, x;
+    byte mask;
+
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= _width) x1 = _width - 1;
+    if (y1 >= _height) y1 = _height - 1;
+    if (x0 > x1 || y0 > y1) return;
+
+    for(p=y0/8; p<=y1/8; p++) {
+        mask = 0xFF;
+        if (p == y0/8) mask &= 0xFF << (y0&7);
+        if (p == y1/8) mask &= 0xFF >> (7 - (y1&7));
+
+        for(x=x0; x<=x1; x++) {
+            _applyMask(p, x, mask, color);
+        }
+    }
+}
+
+
+/**
+ * Convert a row of 8 bits grayscale pixels to black and white and store
+ * it in the buffer, one bit per page byte. Floyd-Steinberg dithering
+ * keeps the error pushed to the next row in err, and the errors pushed
+ * to the right and below-right in locals, so a single buffer is enough.
+ * Pixels outside of the screen still diffuse their error.
+ *
+ * @param  x          Left column
+ * @param  y          Row
+ * @param  w          Number of pixels
+ * @param  row        Pixels, 0 is black and 255 white
+ * @param  dither     OLED_DITHER_THRESHOLD, OLED_DITHER_BAYER or
+ *                    OLED_DITHER_FLOYD
+ * @param  err        w+1 errors, zeroed before the first row (Floyd-
+ *                    Steinberg only, thresholding is used when NULL)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_grayRow(const int x, const int y, const int w,
+                          const byte *row, const byte dither, int16_t *err) {
+    const int  page = y >> 3;
+    const byte mask = 1 << (y & 7);
+    const bool show = y >= 0 && y < _height;
+    int16_t    v, e, right = 0, below = 0, belowRight = 0;
+    bool       on;
+    int        i;
+
+    if (!show && (dither != OLED_DITHER_FLOYD || !err)) return;
+
+    for(i=0; i<w; i++) {
+        switch (dither) {
+            case OLED_DITHER_BAYER:
+                on = row[i] >= pgm_read_byte(&bayer4[y & 3][(x + i) & 3]);
+                break;
+
+            case OLED_DITHER_FLOYD:
+                if (err) {
+                    v  = row[i] + err[i+1] + right;
+                    on = v >= 128;
+                    e  = v - (on ? 255 : 0);
+
+                    /* Pixel i-1 of the next row is now complete */
+                    right      = e * 7 / 16;
+                    err[i]     = below + e * 3 / 16;
+                    below      = belowRight + e * 5 / 16;
+                    belowRight = e / 16;
+                    break;
+                }
+                /* fall through */
+
+            default:
+                on = row[i] >= 128;
+                break;
+        }
+
+        if (show && x + i >= 0 && x + i < _width) {
+            _putByte(page, x + i, on ? (_page(page)[x+i] | mask)
+                                     : (_page(page)[x+i] & ~mask));
+        }
+    }
+
+    if (dither == OLED_DITHER_FLOYD && err) {
+        err[w] = below;
+    }
+}
+
+
+/**
+ * Combine 8 vertical pixels with the buffer, at any row. The byte is
+ * shifted into a 16 bits word and applied to the two pages it overlaps.
+ *
+ * @param  x          Column
+ * @param  y          Row of the first pixel (LSB)
+ * @param  bits       Pixels, LSB on top
+ * @param  n          Number of valid pixels [1 to 8]
+ * @param  rop        Raster operation (OLED_ROP_*)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_blitByte(const int x, const int y, const byte bits,
+                           const int n, const byte rop) {
+    const int      page = y >> 3;
+    const uint16_t mask = (uint16_t)(0xFF >> (8 - n)) << (y & 7);
+    const uint16_t data = (uint16_t)bits << (y & 7) & mask;
+    byte           dst;
+    int            i;
+
+    if (x < 0 || x >= _width) return;
+
+    for(i=0; i<2; i++) {
+        const byte m = mask >> (8*i);
+        const byte d = data >> (8*i);
+
+        if (!m || page+i < 0 || page+i >= _pages) continue;
+
+        dst = _page(page+i)[x];
+        switch (rop) {
+            case OLED_ROP_COPY:   dst = (dst & ~m) | d;   break;
+            case OLED_ROP_OR:     dst |= d;               break;
+            case OLED_ROP_AND:    dst &= d | ~m;          break;
+            case OLED_ROP_XOR:    dst ^= d;               break;
+            case OLED_ROP_ERASE:  dst &= ~d;              break;
+        }
+        _putByte(page+i, x, dst);
+    }
+}
+
+
+/**
+ * Set up and activate a scroll. The scroll must be deactivated before
+ * its parameters are changed.
+ *
+ * @param  cmd        OLED_RIGHTSCROLL, OLED_LEFTSCROLL,
+ *                    OLED_VERTRIGHTSCROLL or OLED_VERTLEFTSCROLL
+ * @param  page0      First page
+ * @param  page1      Last page
+ * @param  offset     Vertical offset per step (diagonal scrolls only)
+ * @param  interval   Time between steps (OLED_SCROLL_*FRAMES)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_startScroll(const byte cmd, const int page0,
+                              const int page1, const int offset,
+                              const byte interval) {
+    _beginStream(OLED_CMD_STREAM);
+    _stream(OLED_SCROLLOFF);
+    _stream(cmd);
+    _stream(0x00);
+    _stream(page0);
+    _stream(interval);
+    _stream(page1);
+    if (offset < 0) {
+        _stream(0x00);
+        _stream(0xFF);
+    } else {
+        _stream(offset);
+    }
+    _stream(OLED_SCROLLON);
+    _endStream();
+
+    /* Diagonal scrolling also moves rows across pages */
+    if (offset < 0) {
+        if (page0 < _scrollFrom) _scrollFrom = (page0 > 0) ? page0 : 0;
+        if (page1 > _scrollTo)   _scrollTo   = (page1 < PAGES - 1) ? page1
+                                                                   : PAGES - 1;
+    } else {
+        _scrollFrom = 0;
+        _scrollTo   = PAGES - 1;
+    }
+}
+
+
+/**
+ * Feed a byte of UTF-8 text to the console, rendering each character once
+ * its sequence is complete. As with utf8Next(), malformed sequences and
+ * code points beyond 16 bits render as U+FFFD.
+ *
+ * @param  b          Byte
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_consoleByte(const byte b) {
+    if (b < 0x80 || b >= 0xC0) {
+        if (_conMore) {
+            _consoleChar(0xFFFD);       /* Truncated sequence */
+        }
+        _conMore = (b < 0x80) ? 0 : (b < 0xE0) ? 1 : (b < 0xF0) ? 2 : 3;
+        _conCode = b & (0x7F >> _conMore);
+    } else if (_conMore) {
+        /* Past 0x3FF the shift overflows 16 bits: 4-byte sequences */
+        _conCode = (_conCode > 0x3FF) ? 0xFFFD : (_conCode << 6) | (b & 0x3F);
+        _conMore--;
+    } else {
+        _conCode = 0xFFFD;              /* Stray continuation byte */
+    }
+
+    if (!_conMore) {
+        _consoleChar(_conCode);
+    }
+}
+
+
+/**
+ * Render a character at the console cursor.
+ *
+ * @param  c          Character code
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_consoleChar(const uint16_t c) {
+    int page, i;
+
+    if (c == '\n') {
+        _consoleNewLine();
+        return;
+    }
+    if (c == '\r') {
+        _conCol = 0;
+        return;
+    }
+    if (_conCol >= _width/8) {
+        _consoleNewLine();
+    }
+    page = (_conTop + _conRow) % _pages;
+
+    for(i=0; i<8; i++) {
+        _putByte(page, 8*_conCol + i, pgm_read_byte(defaultFont.glyph(c) + i));
+    }
+    _conCol++;
+}
+
+
+/**
+ * Move the console cursor to the next line, scrolling if needed.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_consoleNewLine() {
+    int page;
+
+    _conCol = 0;
+    if (_conRow < _pages - 1) {
+        _conRow++;
+        return;
+    }
+
+    if (H == 64 && !(_rotation & 1)) {
+        /* GDDRAM ring: the top page becomes the new bottom row. The start
+         * line follows the frame, see _flushStartLine(). */
+        _conTop = (_conTop + 1) % _pages;
+        page = (_conTop + _pages - 1) % _pages;
+    } else {
+        /* The start line wraps over 64 physical rows: move the buffer */
+        memmove(_page(0), _page(1), (_pages - 1) * _width);
+        _markDirty(0, _pages - 2, 0, _width - 1);
+        page = _pages - 1;
+    }
+
+    memset(_page(page), 0, _width);
+    _markDirty(page, page, 0, _width - 1);
+}
+
+
+/**
+ * Send modified areas to the screen unless buffered mode is enabled.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::_update() {
+    if (!_buffered) {
+        display();
+    }
+}
+
+
+/* ============================ Getters / Setters =========================== */
+
+/**
+ * Get address byte.
+ *
+ * @return  byte containing the I2C address of the device
+ */
+OLED_TEMPLATE
+byte OLED_CLASS::getAddress() {
+    return _bus.getAddress();
+}
+
+
+/**
+ * Set address byte.
+ *
+ * @param  address  Byte containing the I2C address of the device
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setAddress(const byte address) {
+    _bus.setAddress(address);
+}
+
+
+/**
+ * Identify the bus of the device, see OLEDManager.
+ *
+ * @return  Same value for every device on the same bus
+ */
+OLED_TEMPLATE
+const void *OLED_CLASS::getPort() {
+    return _bus.getPort();
+}
+
+
+/**
+ * Hand bulk writes of the transport to a hook, see OLEDDmaHook.
+ *
+ * @param  hook       Hook, NULL to use the transport itself
+ * @param  context    Passed back to the hook
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setDmaHook(OLEDDmaHook hook, void *context) {
+    _bus.setDmaHook(hook, context);
+}
+
+
+/**
+ * Enable/disable buffered mode. When enabled, draw functions only modify
+ * the buffer and the screen is refreshed by calling display().
+ *
+ * @param  val  If true buffered mode is enabled
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setBuffered(const bool val) {
+    _buffered = val;
+}
+
+
+/**
+ * Get buffered mode.
+ *
+ * @return  true if buffered mode is enabled
+ */
+OLED_TEMPLATE
+bool OLED_CLASS::isBuffered() {
+    return _buffered;
+}
+
+
+/**
+ * Enable/disable asynchronous mode. When enabled, display() only queues
+ * modified areas and poll() or pollFor() must be called regularly (e.g. in
+ * loop()) to send them.
+ *
+ * @param  val  If true asynchronous mode is enabled
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setAsync(const bool val) {
+    _async = val;
+}
+
+
+/**
+ * Set a function called from poll() once the last queued byte is sent.
+ *
+ * @param  callback  Function to call, or NULL
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setFlushCallback(void (*callback)()) {
+    _onFlushed = callback;
+}
+
+
+/**
+ * Check whether a frame is still being sent.
+ *
+ * @return  true if queued areas or a start line change remain
+ */
+OLED_TEMPLATE
+bool OLED_CLASS::isFlushing() {
+    int p;
+
+    for(p=0; p<_pages; p++) {
+        if (_pendingFrom[p] <= _pendingTo[p]) return true;
+    }
+    return _shownTop != _startTop;
+}
+
+
+/**
+ * Set/unset inverted display mode.
+ *
+ * @param  val  If true inverted mode is enabled
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setInvertedDisplay(const bool val) {
+    _beginStream(OLED_CMD_STREAM);
+    _stream(val ? OLED_INVERTDISPLAY : OLED_NORMALDISPLAY);
+    _endStream();
+}
+
+
+/**
+ * Set the orientation of the picture. 0 and 180 degrees only change the
+ * segment remap and COM scan direction of the controller, so frames cost
+ * the same in both. 90 and 270 degrees swap the width and height seen by
+ * draw functions (see getWidth()): the buffer keeps the rotated picture in
+ * the usual page layout and 8x8 blocks are transposed while being sent.
+ * Switching between landscape and portrait clears the screen, otherwise
+ * the picture is sent again in the new orientation. Hardware scrolling
+ * keeps the directions of the panel.
+ *
+ * @param  rotation   OLED_ROTATE_0, OLED_ROTATE_90, OLED_ROTATE_180 or
+ *                    OLED_ROTATE_270 (clockwise)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setRotation(const byte rotation) {
+    const bool portrait = (rotation ^ _rotation) & 1;
+
+    _rotation = rotation & 3;
+    _width    = (_rotation & 1) ? H : W;
+    _height   = (_rotation & 1) ? W : H;
+    _pages    = _height / 8;
+
+    _beginStream(OLED_CMD_STREAM);
+    _streamOrientation();
+    _endStream();
+    _resetFrame();
+
+    if (portrait) {
+        clear();
+    } else {
+        _update();
+    }
+}
+
+
+/**
+ * Get the orientation of the picture.
+ *
+ * @return  OLED_ROTATE_0, OLED_ROTATE_90, OLED_ROTATE_180 or OLED_ROTATE_270
+ */
+OLED_TEMPLATE
+byte OLED_CLASS::getRotation() {
+    return _rotation;
+}
+
+
+/**
+ * Mirror the picture, e.g. for a panel seen through a reflector. Like 180
+ * degrees rotation, mirroring is done by the controller at no cost per
+ * frame. Axes are those of the rotated picture.
+ *
+ * @param  x    If true the picture is mirrored left to right
+ * @param  y    If true the picture is mirrored top to bottom
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setMirror(const bool x, const bool y) {
+    _mirrorX = x;
+    _mirrorY = y;
+
+    _beginStream(OLED_CMD_STREAM);
+    _streamOrientation();
+    _endStream();
+    _resetFrame();
+    _update();
+}
+
+
+/**
+ * Get the width of the picture, W or H depending on the rotation.
+ *
+ * @return  Width in pixels
+ */
+OLED_TEMPLATE
+int OLED_CLASS::getWidth() {
+    return _width;
+}
+
+
+/**
+ * Get the height of the picture, H or W depending on the rotation.
+ *
+ * @return  Height in pixels
+ */
+OLED_TEMPLATE
+int OLED_CLASS::getHeight() {
+    return _height;
+}
+
+
+/**
+ * Set, clear or toggle a pixel. In buffered mode only the buffer is
+ * modified, so plots coalesce into the next display().
+ *
+ * @param  row     Pixel row [0 to H-1]
+ * @param  col     Pixel column [0 to W-1]
+ * @param  color   OLED_WHITE (or true), OLED_BLACK (or false), OLED_INVERSE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setPixel(const int row, const int col, const byte color) {
+    OLED_STAT_SCOPE(OLED_STAT_PIXEL);
+    _plot(col, row, color);
+    _update();
+}
+
+
+/**
+ * Set cursor position for 8x8 pixels char.
+ *
+ * @param  X      Character row [0 to 7]
+ * @param  Y      Character column [0 to 15]
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setCharCursor(const int X, const int Y) {
+  setCursor(X, 8*Y);
+}
+
+
+/**
+ * Set cursor position.
+ *
+ * @param  X       Row [0 to 7]
+ * @param  col     Pixel column [0 to 127]
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setCursor(const int X, const int col) {
+  _beginStream(OLED_CMD_STREAM);
+  _stream(0xB0 + X);
+  _stream(OLED_LOWCOLUMN + ((_xoff + col) & 0x0F));
+  _stream(OLED_HIGHCOLUMN + (((_xoff + col)>>4) & 0x0F));
+  _endStream();
+}
+
+
+#ifdef OLED_STATS
+/**
+ * Get I/O statistics collected since the last resetStats().
+ *
+ * @return  statistics
+ */
+OLED_TEMPLATE
+const OLEDStats &OLED_CLASS::getStats() {
+    _stats.transactions = _bus.transactions;
+    return _stats;
+}
+
+
+/**
+ * Reset I/O statistics.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+    _bus.transactions = 0;
+}
+#endif
+
+
+/* ============================ Public Functions ============================ */
+
+/**
+ * Initialize sceen with default settings
+ */
+OLED_TEMPLATE
+void OLED_CLASS::init() {
+    OLED_STAT_SCOPE(OLED_STAT_INIT);
+    _bus.begin();
+    _beginStream(OLED_CMD_STREAM);
+    _streamP(initCmds, sizeof(initCmds));
+    _stream(OLED_SETMULTIPLEX);
+    _stream(H - 1);
+    _stream(OLED_SETCOMPINS);
+    _stream(COMPINS);
+    _streamOrientation();
+    _endStream();
+    _startTop = _shownTop = 0;
+
+    /* GDDRAM content is undefined after power-up: send the whole frame */
+    _invalidate(0, _pages - 1);
+    clear();
+    powerOn();
+}
+
+
+/**
+ * Send modified areas of the buffer to the screen. In asynchronous mode
+ * they are only queued and sent by subsequent poll() calls. In double
+ * buffered mode they are first narrowed to the bytes that differ from the
+ * front buffer (see swap()).
+ */
+OLED_TEMPLATE
+void OLED_CLASS::display() {
+    OLED_STAT_SCOPE(OLED_STAT_DISPLAY);
+    int p;
+
+    for(p=0; p<_pages; p++) {
+#ifdef OLED_DOUBLE_BUFFER
+        if (_dirtyFrom[p] <= _dirtyTo[p]) {
+            _diffPage(p);
+        }
+#endif
+        if (_dirtyFrom[p] > _dirtyTo[p]) {
+            OLED_STAT_ADD(skippedBytes, _width);
+            continue;
+        }
+        OLED_STAT_ADD(skippedBytes, _width - 1 - _dirtyTo[p] + _dirtyFrom[p]);
+
+        if (_dirtyFrom[p] < _pendingFrom[p]) _pendingFrom[p] = _dirtyFrom[p];
+        if (_dirtyTo[p] > _pendingTo[p])     _pendingTo[p]   = _dirtyTo[p];
+        _dirtyFrom[p] = _width;
+        _dirtyTo[p]   = 0;
+    }
+    _startTop = _conTop;
+
+    if (!_async) {
+        _flush(W*H/8);
+    }
+}
+
+
+#ifdef OLED_DOUBLE_BUFFER
+/**
+ * Present the frame drawn since the last swap(). The buffer is compared
+ * with the front buffer, which holds what the screen shows, and only the
+ * changed span of each page is copied and sent, so redrawing a whole frame
+ * every tick only costs what actually moved. Draw in buffered mode. In
+ * asynchronous mode nothing happens while the previous frame is in flight,
+ * so two frames are never mixed on screen: keep drawing and try again.
+ *
+ * @return false if the previous frame is still being sent
+ */
+OLED_TEMPLATE
+bool OLED_CLASS::swap() {
+    if (_async && isFlushing()) return false;
+
+    display();
+    return true;
+}
+#endif
+
+
+/**
+ * Send part of the queued areas.
+ *
+ * @param  budget     Maximum number of data bytes to send
+ * @return true while a frame is still in flight
+ */
+OLED_TEMPLATE
+bool OLED_CLASS::poll(const int budget) {
+    OLED_STAT_SCOPE(OLED_STAT_DISPLAY);
+    _flush(budget);
+    return isFlushing();
+}
+
+
+/**
+ * Send part of the queued areas, like poll(), for schedulers accounting
+ * for bus usage.
+ *
+ * @param  budget     Maximum number of data bytes to send
+ * @return number of data bytes sent
+ */
+OLED_TEMPLATE
+int OLED_CLASS::flushBudget(const int budget) {
+    OLED_STAT_SCOPE(OLED_STAT_DISPLAY);
+    return _flush(budget);
+}
+
+
+/**
+ * Send queued areas, one bus transaction at a time, until the frame is
+ * complete or the time budget is exhausted.
+ *
+ * @param  us         Time budget in microseconds
+ * @return true while a frame is still in flight
+ */
+OLED_TEMPLATE
+bool OLED_CLASS::pollFor(const unsigned long us) {
+    OLED_STAT_SCOPE(OLED_STAT_DISPLAY);
+    unsigned long start = micros();
+
+    while (isFlushing() && micros() - start < us) {
+        _flush(BUS::CHUNK);
+    }
+    return isFlushing();
+}
+
+
+/**
+ * Clear all displayed data and buffer. The console cursor moves back to
+ * the top left corner.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::clear() {
+    OLED_STAT_SCOPE(OLED_STAT_CLEAR);
+    _clearBuffer();
+    _conRow = _conCol = _conTop = 0;
+    memset(_fields, 0, sizeof(_fields));
+    _update();
+}
+
+
+/**
+ * Clear character on screen and in buffer.
+ *
+ * @param  X      Character row [0 to 7]
+ * @param  Y      Character column [0 to 15]
+ */
+OLED_TEMPLATE
+void OLED_CLASS::clearChar(const int X, const int Y) {
+    OLED_STAT_SCOPE(OLED_STAT_CLEAR);
+    _clearCharBuffer(X, Y);
+    _update();
+}
+
+
+/**
+ * Clear character row on screen and in buffer.
+ *
+ * @param  X      Character row [0 to 7]
+ */
+OLED_TEMPLATE
+void OLED_CLASS::clearCharRow(const int X) {
+    OLED_STAT_SCOPE(OLED_STAT_CLEAR);
+    int i;
+
+    if (X < 0 || X >= _pages) return;
+    for(i=0; i<_width; i++) {
+        _putByte(X, i, 0);
+    }
+    _update();
+}
+
+
+/**
+ * Power off the screen to save power.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::powerOn() {
+    _beginStream(OLED_CMD_STREAM);
+    _stream(OLED_ON);
+    _endStream();
+}
+
+
+/**
+ * Power on the screen.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::powerOff() {
+    _beginStream(OLED_CMD_STREAM);
+    _stream(OLED_OFF);
+    _endStream();
+}
+
+
+/**
+ * Start continuous horizontal scrolling to the right. The controller
+ * animates the pages by itself, without any bus traffic.
+ *
+ * @param  page0          First page [0 to PAGES-1]
+ * @param  page1          Last page [page0 to PAGES-1]
+ * @param  interval       Time between steps (OLED_SCROLL_*FRAMES)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::startScrollRight(const int page0, const int page1,
+                                  const byte interval) {
+    OLED_STAT_SCOPE(OLED_STAT_SCROLL);
+    _startScroll(OLED_RIGHTSCROLL, page0, page1, -1, interval);
+}
+
+
+/**
+ * Start continuous horizontal scrolling to the left.
+ *
+ * @param  page0          First page [0 to PAGES-1]
+ * @param  page1          Last page [page0 to PAGES-1]
+ * @param  interval       Time between steps (OLED_SCROLL_*FRAMES)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::startScrollLeft(const int page0, const int page1,
+                                 const byte interval) {
+    OLED_STAT_SCOPE(OLED_STAT_SCROLL);
+    _startScroll(OLED_LEFTSCROLL, page0, page1, -1, interval);
+}
+
+
+/**
+ * Start continuous diagonal scrolling: pages [page0, page1] move to the
+ * right while the vertical scroll area (see setScrollArea()) moves up by
+ * offset rows per step.
+ *
+ * @param  page0          First page [0 to PAGES-1]
+ * @param  page1          Last page [page0 to PAGES-1]
+ * @param  offset         Vertical offset per step [0 to H-1]
+ * @param  interval       Time between steps (OLED_SCROLL_*FRAMES)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::startScrollDiagRight(const int page0, const int page1,
+                                      const int offset, const byte interval) {
+    OLED_STAT_SCOPE(OLED_STAT_SCROLL);
+    _startScroll(OLED_VERTRIGHTSCROLL, page0, page1, offset, interval);
+}
+
+
+/**
+ * Start continuous diagonal scrolling to the left.
+ *
+ * @param  page0          First page [0 to PAGES-1]
+ * @param  page1          Last page [page0 to PAGES-1]
+ * @param  offset         Vertical offset per step [0 to H-1]
+ * @param  interval       Time between steps (OLED_SCROLL_*FRAMES)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::startScrollDiagLeft(const int page0, const int page1,
+                                     const int offset, const byte interval) {
+    OLED_STAT_SCOPE(OLED_STAT_SCROLL);
+    _startScroll(OLED_VERTLEFTSCROLL, page0, page1, offset, interval);
+}
+
+
+/**
+ * Set the rows moved by diagonal scrolling. Rows above stay fixed.
+ *
+ * @param  top            Number of fixed rows on top
+ * @param  rows           Number of rows in the scroll area
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setScrollArea(const int top, const int rows) {
+    OLED_STAT_SCOPE(OLED_STAT_SCROLL);
+    _beginStream(OLED_CMD_STREAM);
+    _stream(OLED_SETVERTSCROLLAREA);
+    _stream(top);
+    _stream(rows);
+    _endStream();
+}
+
+
+/**
+ * Stop scrolling. Scrolling moves data inside GDDRAM, so the scrolled
+ * pages are sent again from the buffer to resynchronize the screen (by
+ * the next display() in buffered mode). Use scrollBuffer() beforehand to
+ * keep the content where it stopped instead.
+ */
+OLED_TEMPLATE
+void OLED_CLASS::stopScroll() {
+    OLED_STAT_SCOPE(OLED_STAT_SCROLL);
+    _beginStream(OLED_CMD_STREAM);
+    _stream(OLED_SCROLLOFF);
+    _endStream();
+
+    if (_scrollFrom <= _scrollTo) {
+        if (_rotation & 1) {
+            /* Scrolled physical pages cross every page of the buffer */
+            _invalidate(0, _pages - 1);
+        } else {
+            _invalidate(_scrollFrom, _scrollTo);
+        }
+        _scrollFrom = PAGES;
+        _scrollTo   = 0;
+        _update();
+    }
+}
+
+
+/**
+ * Move pages of the buffer horizontally, like the scroll engine does. The
+ * engine rotates all 128 GDDRAM columns: on panels narrower than 128
+ * columns, content leaves the visible window and the hidden columns come
+ * in blank. In portrait the engine moves buffer rows across pages instead,
+ * so the buffer is left as is and stopScroll() sends it again.
+ *
+ * @param  page0          First page [0 to PAGES-1]
+ * @param  page1          Last page [page0 to PAGES-1]
+ * @param  dx             Columns the engine moved to the right (negative
+ *                        to the left)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::scrollBuffer(int page0, int page1, const int dx) {
+    OLED_STAT_SCOPE(OLED_STAT_SCROLL);
+    byte row[(W < 128) ? W : 1];    /* Narrow panels only */
+    int  n, p, i, src;
+
+    if (page0 < 0)         page0 = 0;
+    if (page1 > PAGES - 1) page1 = PAGES - 1;
+    if (page0 > page1 || (_rotation & 1)) return;
+
+    /* Segment remap reverses the engine along the buffer columns */
+    n = ((dx % 128) + 128) % 128;
+    if ((_rotation == OLED_ROTATE_180) != _mirrorX) {
+        n = (128 - n) % 128;
+    }
+    if (n == 0) return;
+
+    for(p=page0; p<=page1; p++) {
+        if (W == 128) {
+            /* Rotate right by n: reverse the page, then both parts */
+            reverseBytes(_page(p), 0, W - 1);
+            reverseBytes(_page(p), 0, n - 1);
+            reverseBytes(_page(p), n, W - 1);
+            continue;
+        }
+        memcpy(row, _page(p), W);
+        for(i=0; i<W; i++) {
+            src = (i - n + 128) % 128;
+            _page(p)[i] = (src < W) ? row[src] : 0;
+        }
+    }
+    _markDirty(page0, page1, 0, W - 1);
+    _update();
+}
+
+
+/**
+ * Send everything queued (Print interface), e.g. console output printed in
+ * asynchronous mode. Areas drawn in buffered mode still wait for display().
+ */
+OLED_TEMPLATE
+void OLED_CLASS::flush() {
+    OLED_STAT_SCOPE(OLED_STAT_DISPLAY);
+    while (isFlushing()) {
+        _flush(W*H/8);
+    }
+}
+
+
+/**
+ * Print a character on the console (Print interface). The console uses
+ * the default font on a grid of PAGES rows of W/8 characters. Lines wrap
+ * and, once the last row is full, the screen scrolls up by one row.
+ *
+ * On 64 rows screens scrolling moves the display start line: GDDRAM is
+ * used as a ring of pages, so a new line only costs one command and one
+ * cleared page. Other draw functions address GDDRAM pages directly and
+ * appear shifted until clear() is called.
+ *
+ * @param  c              Character ('\n' new line, '\r' carriage return)
+ * @return 1
+ */
+OLED_TEMPLATE
+size_t OLED_CLASS::write(uint8_t c) {
+    OLED_STAT_SCOPE(OLED_STAT_CONSOLE);
+    _consoleByte(c);
+    _update();
+    return 1;
+}
+
+
+/**
+ * Print characters on the console, flushed once.
+ *
+ * @param  buffer         Characters
+ * @param  size           Number of characters
+ * @return number of characters printed
+ */
+OLED_TEMPLATE
+size_t OLED_CLASS::write(const uint8_t *buffer, size_t size) {
+    OLED_STAT_SCOPE(OLED_STAT_CONSOLE);
+    size_t i;
+
+    for(i=0; i<size; i++) {
+        _consoleByte(buffer[i]);
+    }
+    _update();
+    return size;
+}
+
+
+/**
+ * Set console cursor position.
+ *
+ * @param  X      Character row [0 to PAGES-1]
+ * @param  Y      Character column [0 to W/8-1]
+ */
+OLED_TEMPLATE
+void OLED_CLASS::setConsoleCursor(const int X, const int Y) {
+    _conRow = X;
+    _conCol = Y;
+}
+
+
+/**
+ * Draw a progress bar. On 128 pixels wide screens the bar is 100 pixels
+ * long, framed by columns 12 and 113. The whole bar is redrawn in the
+ * buffer but only columns that changed since the last call are sent.
+ *
+ * @param  X              Character row [0 to 7]
+ * @param  percent        Percentage
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawProgressBar(const int X, const int percent) {
+    OLED_STAT_SCOPE(OLED_STAT_WIDGET);
+    const int len  = (_width - 4 < 100) ? _width - 4 : 100;
+    const int left = (_width - len - 4) / 2;
+    int i;
+
+    if (X < 0 || X >= _pages) return;
+
+    /* Draw layout and progress bar */
+    _putByte(X, left, 0x7E);
+    for(i=0;i<len;i++) {
+        _putByte(X, left+1+i, (percent*len >= i*100) ? 0x7E : 0x42);
+    }
+    _putByte(X, left+1+len, 0x7E);
+    _update();
+}
+
+
+/**
+ * Draw a vertical level meter: a frame filled from the bottom. Only the
+ * rows that changed since the last call are sent.
+ *
+ * @param  x              Left column
+ * @param  y              Top row
+ * @param  w              Width in pixels (frame included)
+ * @param  h              Height in pixels (frame included)
+ * @param  percent        Level [0 to 100]
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawLevelMeter(const int x, const int y, const int w,
+                                const int h, int percent) {
+    OLED_STAT_SCOPE(OLED_STAT_WIDGET);
+    int level;
+
+    if (w < 3 || h < 3) return;
+    if (percent < 0)   percent = 0;
+    if (percent > 100) percent = 100;
+    level = (h - 2) * percent / 100;
+
+    _fill(x, y, x + w - 1, y, OLED_WHITE);
+    _fill(x, y + h - 1, x + w - 1, y + h - 1, OLED_WHITE);
+    _fill(x, y + 1, x, y + h - 2, OLED_WHITE);
+    _fill(x + w - 1, y + 1, x + w - 1, y + h - 2, OLED_WHITE);
+
+    _fill(x + 1, y + 1, x + w - 2, y + h - 2 - level, OLED_BLACK);
+    _fill(x + 1, y + h - 1 - level, x + w - 2, y + h - 2, OLED_WHITE);
+    _update();
+}
+
+
+/**
+ * Draw a spinner (rotating bar) in a character cell. Only the columns
+ * that differ from the previous phase are sent.
+ *
+ * @param  X              Character row [0 to 7]
+ * @param  Y              Character column [0 to 15]
+ * @param  phase          Animation step, any value (4 steps per turn)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawSpinner(const int X, const int Y, const unsigned int phase) {
+    OLED_STAT_SCOPE(OLED_STAT_WIDGET);
+    int i;
+
+    if (X < 0 || X >= _pages || Y < 0 || 8*Y + 8 > _width) return;
+    for(i=0; i<8; i++) {
+        _putByte(X, 8*Y + i, pgm_read_byte(spinnerFrames[phase % 4] + i));
+    }
+    _update();
+}
+
+
+/**
+ * Draw string of char using default font.
+ *
+ * @param  string         UTF-8 string to draw
+ * @param  X              Start row [0 to 7]
+ * @param  Y              Start column [0 to 15]
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawStr(const char *string, const int X, const int Y) {
+    OLED_STAT_SCOPE(OLED_STAT_STR);
+    drawStr(string, X, Y, defaultFont);
+}
+
+
+/**
+ * Draw string of char using a sparse font. Glyphs taller than 8 pixels
+ * span several character rows. Characters beyond the right edge of the
+ * screen are clipped.
+ *
+ * @param  string         UTF-8 string to draw
+ * @param  X              Start row [0 to 7]
+ * @param  Y              Start column [0 to 15]
+ * @param  font           Font to use
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawStr(const char *string, const int X, const int Y,
+                                                      const OLEDFont &font) {
+    OLED_STAT_SCOPE(OLED_STAT_STR);
+    const byte *glyph;
+    int col = 8*Y;
+    int i, p;
+
+    if (X < 0 || X >= _pages || Y < 0) return;
+    while(*string && col < _width) {
+        glyph = font.glyph(utf8Next(&string));
+        for(p=0; p<font.height/8 && X+p<_pages; p++) {
+            for(i=0; i<font.width && col+i<_width; i++) {
+                _putByte(X+p, col+i, pgm_read_byte(glyph + p*font.width + i));
+            }
+        }
+        col += font.width;
+    }
+    _update();
+}
+
+
+/**
+ * Draw text with the proportional default font at any pixel position.
+ *
+ * @param  string         UTF-8 string to draw
+ * @param  x              Left column of the first glyph
+ * @param  y              Top row of the glyphs
+ * @return column following the last glyph
+ */
+OLED_TEMPLATE
+int OLED_CLASS::drawText(const char *string, const int x, const int y) {
+    return drawText(string, x, y, defaultPropFont);
+}
+
+
+/**
+ * Draw text at any pixel position. Each glyph column is shifted across
+ * page boundaries a byte at a time; columns between the glyph and its
+ * advance are blank. Text outside the screen is clipped.
+ *
+ * @param  string         UTF-8 string to draw
+ * @param  x              Left column of the first glyph
+ * @param  y              Top row of the glyphs
+ * @param  font           Font to use
+ * @param  rop            Raster operation (OLED_ROP_*), copy paints the
+ *                        background of the glyph cells too
+ * @return column following the last glyph
+ */
+OLED_TEMPLATE
+int OLED_CLASS::drawText(const char *string, const int x, const int y,
+                         const OLEDFont &font, const byte rop) {
+    OLED_STAT_SCOPE(OLED_STAT_STR);
+    const byte *glyph;
+    uint16_t c;
+    int col = x;
+    int adv, i, p;
+    byte bits;
+
+    if (y + font.height <= 0 || y >= _height) return x + font.textWidth(string);
+
+    for(; *string && col < _width; col += adv) {
+        c   = utf8Next(&string);
+        adv = font.advance(c);
+        if (col + adv <= 0) continue;
+
+        glyph = font.glyph(c);
+        for(p=0; p<font.height/8; p++) {
+            for(i=0; i<adv; i++) {
+                bits = (i < font.width) ? pgm_read_byte(glyph + p*font.width + i) : 0;
+                _blitByte(col + i, y + 8*p, bits, 8, rop);
+            }
+        }
+    }
+    _update();
+    return col + font.textWidth(string);
+}
+
+
+/**
+ * Draw string of char using a dense font, 8x8 glyphs for each of the 256
+ * character codes. Characters beyond the right edge of the screen are
+ * clipped.
+ *
+ * @param  string         String to draw (one byte per character)
+ * @param  X              Start row [0 to 7]
+ * @param  Y              Start column [0 to 15]
+ * @param  font           Font to use
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawStr(const char *string, const int X, const int Y,
+                                                      const char font[256][8]) {
+    OLED_STAT_SCOPE(OLED_STAT_STR);
+    int col = 8*Y;
+    char i=0;
+
+    if (X < 0 || X >= _pages || Y < 0) return;
+    while(*string && col < _width) {
+        for(i=0;i<8 && col<_width;i++) {
+            _putByte(X, col++, pgm_read_byte(font[(unsigned char)*string]+i));
+        }
+        string++;
+    }
+    _update();
+}
+
+
+/**
+ * Draw an integer, right aligned in a field of characters. Cells left
+ * over by a longer number drawn at the same place are blanked, and only
+ * glyphs whose value changed since the last call are sent, so a counter
+ * ticking by one usually costs a single character.
+ *
+ * @param  value          Number to draw
+ * @param  X              Character row [0 to 7]
+ * @param  Y              First column of the field [0 to 15]
+ * @param  width          Field width in characters, 0 for no padding
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawInt(const long value, const int X, const int Y,
+                                                         const int width) {
+    OLED_STAT_SCOPE(OLED_STAT_NUMBER);
+    drawFixed(value, 0, X, Y, width);
+}
+
+
+/**
+ * Draw a fixed point number, right aligned in a field of characters. For
+ * example 2345 with 2 decimals is drawn as "23.45".
+ *
+ * @param  value          Number scaled by 10^decimals
+ * @param  decimals       Digits after the decimal point [0 to 9]
+ * @param  X              Character row [0 to 7]
+ * @param  Y              First column of the field [0 to 15]
+ * @param  width          Field width in characters, 0 for no padding
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawFixed(const long value, int decimals,
+                           const int X, const int Y, const int width) {
+    OLED_STAT_SCOPE(OLED_STAT_NUMBER);
+    char  buf[OLED_NUMBER_LEN + 1];
+    char *s;
+    int   len, last;
+
+    if (X < 0 || X >= _pages || Y < 0) return;
+    if (decimals < 0) decimals = 0;
+    if (decimals > 9) decimals = 9;
+    s    = formatFixed(buf + OLED_NUMBER_LEN, value, decimals, width);
+    len  = buf + OLED_NUMBER_LEN - s;
+    last = _numberField(X, Y, len);
+
+    /* Blank the cells of a longer previous number */
+    if (last > len) {
+        memmove(buf, s, len);
+        memset(buf + len, ' ', last - len);
+        buf[last] = 0;
+        s = buf;
+    }
+    drawStr(s, X, Y);
+}
+
+
+/**
+ * Remember the length of the number drawn at a position, taking over the
+ * oldest entry for a new position.
+ *
+ * @param  X              Character row
+ * @param  Y              First column of the field
+ * @param  len            Length of the new number
+ * @return length of the previous number at this position, 0 if unknown
+ */
+OLED_TEMPLATE
+int OLED_CLASS::_numberField(const int X, const int Y, const int len) {
+    int i, last;
+
+    for(i=0; i<OLED_NUMBER_FIELDS; i++) {
+        if (_fields[i].len && _fields[i].row == X && _fields[i].col == Y) {
+            last = _fields[i].len;
+            _fields[i].len = len;
+            return last;
+        }
+    }
+
+    i = _nextField;
+    _nextField = (_nextField + 1) % OLED_NUMBER_FIELDS;
+    _fields[i].row = X;
+    _fields[i].col = Y;
+    _fields[i].len = len;
+    return 0;
+}
+
+
+/**
+ * Draw a float rounded to a number of decimals, right aligned in a field
+ * of characters. The value must fit a long once scaled.
+ *
+ * @param  value          Number to draw
+ * @param  decimals       Digits after the decimal point [0 to 6]
+ * @param  X              Character row [0 to 7]
+ * @param  Y              First column of the field [0 to 15]
+ * @param  width          Field width in characters, 0 for no padding
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawFloat(const float value, int decimals,
+                           const int X, const int Y, const int width) {
+    OLED_STAT_SCOPE(OLED_STAT_NUMBER);
+    float scaled = value;
+    int   i;
+
+    if (decimals < 0) decimals = 0;
+    if (decimals > 6) decimals = 6;
+    for(i=0; i<decimals; i++) {
+        scaled *= 10;
+    }
+    drawFixed((long)(scaled + ((scaled < 0) ? -0.5f : 0.5f)), decimals,
+              X, Y, width);
+}
+
+
+/**
+ * Draw an image.
+ *
+ * @param  data         Image to draw
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawImage(const char *data){
+    OLED_STAT_SCOPE(OLED_STAT_IMAGE);
+    memcpy_P(_buffer, data, sizeof(_buffer));
+    _markDirty(0, _pages - 1, 0, _width - 1);
+    _update();
+}
+
+
+/**
+ * Draw a run-length encoded image, decoded straight into the buffer. The
+ * stream is a sequence of tokens: a byte n < 0x80 is followed by n+1
+ * literal bytes, a byte n >= 0x80 is followed by one byte repeated
+ * (n & 0x7F)+1 times. Decoded bytes use the drawImage() format. Use
+ * extras/tools/oledrle.cpp to encode images.
+ *
+ * @param  data         Encoded image (PROGMEM)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawImageRLE(const char *data) {
+    OLED_STAT_SCOPE(OLED_STAT_IMAGE);
+    byte *dst = _buffer;
+    byte *end = dst + sizeof(_buffer);
+    int   n;
+    byte  token;
+
+    while (dst < end) {
+        token = pgm_read_byte(data++);
+        n = (token & 0x7F) + 1;
+        if (n > end - dst) n = end - dst;
+
+        if (token & 0x80) {
+            memset(dst, pgm_read_byte(data++), n);
+        } else {
+            memcpy_P(dst, data, n);
+            data += n;
+        }
+        dst += n;
+    }
+    _markDirty(0, _pages - 1, 0, _width - 1);
+    _update();
+}
+
+
+/**
+ * Draw a run-length encoded bitmap at any position. The stream uses the
+ * drawImageRLE() tokens and decodes to the drawBitmap() format.
+ *
+ * @param  x            Left column
+ * @param  y            Top row
+ * @param  w            Width in pixels
+ * @param  h            Height in pixels
+ * @param  data         Encoded bitmap (PROGMEM)
+ * @param  rop          Raster operation (OLED_ROP_*)
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawBitmapRLE(const int x, const int y, const int w,
+                               const int h, const char *data, const byte rop) {
+    OLED_STAT_SCOPE(OLED_STAT_BITMAP);
+    int  row = 0, col = 0, n;
+    byte token, value = 0;
+
+    if (w <= 0 || h <= 0) return;
+    while (row < h) {
+        token = pgm_read_byte(data++);
+        if (token & 0x80) {
+            value = pgm_read_byte(data++);
+        }
+
+        for(n=(token & 0x7F)+1; n>0 && row<h; n--) {
+            if (!(token & 0x80)) {
+                value = pgm_read_byte(data++);
+            }
+            _blitByte(x + col, y + row, value, (h - row < 8) ? h - row : 8, rop);
+
+            if (++col == w) {
+                col  = 0;
+                row += 8;
+            }
+        }
+    }
+    _update();
+}
+
+
+/**
+ * Draw a row of a grayscale image produced on the fly (camera, chart...),
+ * converted to black and white. Rows are fed top to bottom; the screen is
+ * refreshed each time a row completes a page, call display() after the
+ * last row when the image does not end on a page boundary.
+ *
+ * @param  x            Left column
+ * @param  y            Row
+ * @param  w            Number of pixels
+ * @param  row          Pixels (RAM), 0 is black and 255 white
+ * @param  dither       OLED_DITHER_THRESHOLD, OLED_DITHER_BAYER or
+ *                      OLED_DITHER_FLOYD
+ * @param  err          Floyd-Steinberg error buffer: w+1 values, zeroed
+ *                      before the first row of the image
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawGrayRow(const int x, const int y, const int w,
+                             const byte *row, const byte dither,
+                             int16_t *err) {
+    OLED_STAT_SCOPE(OLED_STAT_IMAGE);
+    _grayRow(x, y, w, row, dither, err);
+    if ((y & 7) == 7 || y == _height - 1) {
+        _update();
+    }
+}
+
+
+/**
+ * Draw a grayscale image held in RAM, converted to black and white.
+ *
+ * @param  x            Left column
+ * @param  y            Top row
+ * @param  w            Width in pixels
+ * @param  h            Height in pixels
+ * @param  pixels       Rows of w pixels (RAM), 0 is black and 255 white
+ * @param  dither       OLED_DITHER_THRESHOLD, OLED_DITHER_BAYER or
+ *                      OLED_DITHER_FLOYD
+ * @param  err          Floyd-Steinberg error buffer of w+1 values, its
+ *                      content is overwritten
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawGray(const int x, const int y, const int w, const int h,
+                          const byte *pixels, const byte dither,
+                          int16_t *err) {
+    OLED_STAT_SCOPE(OLED_STAT_IMAGE);
+    int j;
+
+    if (err) {
+        memset(err, 0, (w + 1) * sizeof(int16_t));
+    }
+    for(j=0; j<h; j++, pixels+=w) {
+        _grayRow(x, y + j, w, pixels, dither, err);
+    }
+    _update();
+}
+
+
+/**
+ * Draw a bitmap at any position. The bitmap uses the drawImage() format:
+ * (h+7)/8 rows of w bytes, each byte holding 8 vertical pixels (LSB on
+ * top). Pixels outside of the screen are clipped.
+ *
+ * @param  x            Left column
+ * @param  y            Top row
+ * @param  w            Width in pixels
+ * @param  h            Height in pixels
+ * @param  data         Bitmap to draw (PROGMEM)
+ * @param  rop          OLED_ROP_COPY, OLED_ROP_OR (OLED_ROP_TRANSPARENT),
+ *                      OLED_ROP_AND, OLED_ROP_XOR or OLED_ROP_ERASE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawBitmap(const int x, const int y, const int w,
+                            const int h, const char *data, const byte rop) {
+    OLED_STAT_SCOPE(OLED_STAT_BITMAP);
+    int row, i, n;
+
+    for(row=0; row<h; row+=8, data+=w) {
+        n = (h - row < 8) ? h - row : 8;
+        if (y + row + n <= 0 || y + row >= _height) continue;
+
+        for(i=0; i<w; i++) {
+            _blitByte(x + i, y + row, pgm_read_byte(data + i), n, rop);
+        }
+    }
+    _update();
+}
+
+
+/**
+ * Draw a row-major bitmap at any position, as exported by most tools (XBM,
+ * PBM, GIMP, Adafruit GFX): h rows of (w+7)/8 bytes, each byte holding 8
+ * horizontal pixels. Tiles of 8x8 pixels are transposed on the fly to the
+ * drawBitmap() layout, no offline conversion is needed.
+ *
+ * @param  x            Left column
+ * @param  y            Top row
+ * @param  w            Width in pixels
+ * @param  h            Height in pixels
+ * @param  data         Bitmap to draw (PROGMEM)
+ * @param  rop          Raster operation (OLED_ROP_*)
+ * @param  order        OLED_MSB_FIRST (PBM, GIMP, Adafruit GFX) or
+ *                      OLED_LSB_FIRST (XBM): bit of the leftmost pixel
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawBitmapRowMajor(const int x, const int y, const int w,
+                                    const int h, const char *data,
+                                    const byte rop, const byte order) {
+    OLED_STAT_SCOPE(OLED_STAT_BITMAP);
+    const int stride = (w + 7) >> 3;
+    byte      rows[8], cols[8];
+    int       row, tile, col, i, n;
+
+    for(row=0; row<h; row+=8, data+=8*stride) {
+        n = (h - row < 8) ? h - row : 8;
+        if (y + row + n <= 0 || y + row >= _height) continue;
+
+        for(tile=0; tile<stride; tile++) {
+            col = 8*tile;
+            if (x + col + 8 <= 0 || x + col >= _width) continue;
+
+            for(i=0; i<8; i++) {
+                rows[i] = (i < n) ? pgm_read_byte(data + i*stride + tile) : 0;
+            }
+            transpose8(rows, cols);
+
+            for(i=0; i<8 && col+i<w; i++) {
+                _blitByte(x + col + i, y + row,
+                          cols[(order == OLED_LSB_FIRST) ? 7 - i : i], n, rop);
+            }
+        }
+    }
+    _update();
+}
+
+
+/**
+ * Draw a horizontal line.
+ *
+ * @param  row         Row where the line has to be drawn
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawHLine(const int row){
+    OLED_STAT_SCOPE(OLED_STAT_SHAPE);
+    _fill(0, row, _width - 1, row, OLED_WHITE);
+    _update();
+}
+
+
+/**
+ * Draw a vertical line.
+ *
+ * @param  col         Column where the line has to be drawn
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawVLine(const int col){
+    OLED_STAT_SCOPE(OLED_STAT_SHAPE);
+    _fill(col, 0, col, _height - 1, OLED_WHITE);
+    _update();
+}
+
+
+/**
+ * Draw a line between two points (Bresenham). Horizontal and vertical
+ * lines are filled with byte masks.
+ *
+ * @param  x0         Start column
+ * @param  y0         Start row
+ * @param  x1         End column
+ * @param  y1         End row
+ * @param  color      OLED_WHITE, OLED_BLACK or OLED_INVERSE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawLine(int x0, int y0, const int x1, const int y1,
+                          const byte color) {
+    OLED_STAT_SCOPE(OLED_STAT_SHAPE);
+    const int dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+    const int dy = (y1 > y0) ? y0 - y1 : y1 - y0;
+    const int sx = (x0 < x1) ? 1 : -1;
+    const int sy = (y0 < y1) ? 1 : -1;
+    int err = dx + dy, e2;
+
+    if (x0 == x1 || y0 == y1) {
+        _fill(x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1,
+              x0 < x1 ? x1 : x0, y0 < y1 ? y1 : y0, color);
+        _update();
+        return;
+    }
+
+    for(;;) {
+        _plot(x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+
+        e2 = 2*err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+    _update();
+}
+
+
+/**
+ * Draw the outline of a rectangle.
+ *
+ * @param  x          Left column
+ * @param  y          Top row
+ * @param  w          Width in pixels
+ * @param  h          Height in pixels
+ * @param  color      OLED_WHITE, OLED_BLACK or OLED_INVERSE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawRect(const int x, const int y, const int w, const int h,
+                          const byte color) {
+    OLED_STAT_SCOPE(OLED_STAT_SHAPE);
+    if (w <= 0 || h <= 0) return;
+
+    _fill(x, y, x + w - 1, y, color);
+    if (h > 1) {
+        _fill(x, y + h - 1, x + w - 1, y + h - 1, color);
+    }
+    if (h > 2) {
+        _fill(x, y + 1, x, y + h - 2, color);
+        if (w > 1) {
+            _fill(x + w - 1, y + 1, x + w - 1, y + h - 2, color);
+        }
+    }
+    _update();
+}
+
+
+/**
+ * Fill a rectangle.
+ *
+ * @param  x          Left column
+ * @param  y          Top row
+ * @param  w          Width in pixels
+ * @param  h          Height in pixels
+ * @param  color      OLED_WHITE, OLED_BLACK or OLED_INVERSE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::fillRect(const int x, const int y, const int w, const int h,
+                          const byte color) {
+    OLED_STAT_SCOPE(OLED_STAT_SHAPE);
+    if (w <= 0 || h <= 0) return;
+
+    _fill(x, y, x + w - 1, y + h - 1, color);
+    _update();
+}
+
+
+/**
+ * Draw the outline of a circle (midpoint algorithm). Every pixel is drawn
+ * once, so OLED_INVERSE toggles the whole outline.
+ *
+ * @param  cx         Center column
+ * @param  cy         Center row
+ * @param  r          Radius in pixels
+ * @param  color      OLED_WHITE, OLED_BLACK or OLED_INVERSE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::drawCircle(const int cx, const int cy, const int r,
+                            const byte color) {
+    OLED_STAT_SCOPE(OLED_STAT_SHAPE);
+    int x = 0, y = r, d = 1 - r;
+
+    if (r < 0) return;
+    if (r == 0) {
+        _plot(cx, cy, color);
+        _update();
+        return;
+    }
+
+    _plot(cx, cy + r, color);
+    _plot(cx, cy - r, color);
+    _plot(cx + r, cy, color);
+    _plot(cx - r, cy, color);
+
+    for(;;) {
+        x++;
+        if (d < 0) {
+            d += 2*x + 1;
+        } else {
+            y--;
+            d += 2*(x - y) + 1;
+        }
+        if (x > y) break;
+
+        _plot(cx + x, cy + y, color);
+        _plot(cx - x, cy + y, color);
+        _plot(cx + x, cy - y, color);
+        _plot(cx - x, cy - y, color);
+        if (x == y) break;
+
+        _plot(cx + y, cy + x, color);
+        _plot(cx - y, cy + x, color);
+        _plot(cx + y, cy - x, color);
+        _plot(cx - y, cy - x, color);
+    }
+    _update();
+}
+
+
+/**
+ * Fill a circle with one vertical span per column.
+ *
+ * @param  cx         Center column
+ * @param  cy         Center row
+ * @param  r          Radius in pixels
+ * @param  color      OLED_WHITE, OLED_BLACK or OLED_INVERSE
+ */
+OLED_TEMPLATE
+void OLED_CLASS::fillCircle(const int cx, const int cy, const int r,
+                            const byte color) {
+    OLED_STAT_SCOPE(OLED_STAT_SHAPE);
+    int dx, h = r;
+
+    if (r < 0) return;
+
+    for(dx=0; dx<=r; dx++) {
+        /* Largest h with dx^2 + h^2 <= r^2 + r */
+        while (h > 0 && dx*dx + h*h > r*r + r) h--;
+
+        _fill(cx + dx, cy - h, cx + dx, cy + h, color);
+        if (dx) {
+            _fill(cx - dx, cy - h, cx - dx, cy + h, color);
+        }
+    }
+    _update();
+}
+
+/* Supported geometries */
+template class SSD1306<128, 64>;
+template class SSD1306<128, 32>;
+template class SSD1306<96, 16>;
+template class SSD1306<72, 40, 28>;
+template class SSD1306<64, 48, 32>;
+template class SSD1306<64, 32, 32>;
+template class SSD1306<128, 64, 0, OLEDSPI>;
+template class SSD1306<128, 32, 0, OLEDSPI>;
+
+
+#ifndef OLED_NO_GLOBAL
+OLED128x64 OLED;
+#endif
+
+
+/* Default font: Quadrang. Glyph 0 is the placeholder drawn for missing
+ * characters, glyphs 1 to 95 are printable ASCII, glyphs 96 to 119 are
+ * degree and micro signs, accented letters and arrows. */
+static const char defaultGlyphs[][8] PROGMEM = {
 {0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
 {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
 {0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
@@ -546,133 +3027,249 @@ const char defaultFont[][8] PROGMEM = {
 {0x00, 0x00, 0x00, 0x1e, 0x1e, 0x00, 0x00, 0x00},
 {0x00, 0x00, 0x3e, 0x3c, 0x08, 0x00, 0x00, 0x00},
 {0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00},
-{0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00}
+{0x00, 0x00, 0x07, 0x05, 0x07, 0x00, 0x00, 0x00},
+{0x00, 0x3c, 0x3c, 0x10, 0x1c, 0x1c, 0x00, 0x00},
+{0x00, 0x1e, 0x1f, 0x0a, 0x1f, 0x1e, 0x00, 0x00},
+{0x00, 0x1e, 0x1e, 0x17, 0x17, 0x16, 0x00, 0x00},
+{0x00, 0x1e, 0x1f, 0x12, 0x1f, 0x1e, 0x00, 0x00},
+{0x00, 0x1e, 0x1f, 0x10, 0x1f, 0x1e, 0x00, 0x00},
+{0x00, 0x1c, 0x1d, 0x1e, 0x1c, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1e, 0x1d, 0x1e, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1e, 0x1c, 0x1e, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x5c, 0x34, 0x14, 0x14, 0x00, 0x00},
+{0x00, 0x1c, 0x1d, 0x1e, 0x1c, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1c, 0x1e, 0x1d, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1e, 0x1d, 0x1e, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1e, 0x1c, 0x1e, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1e, 0x05, 0x1e, 0x1d, 0x00, 0x00},
+{0x00, 0x1c, 0x1e, 0x15, 0x1e, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1e, 0x14, 0x1e, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1d, 0x12, 0x1c, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1e, 0x11, 0x1e, 0x1c, 0x00, 0x00},
+{0x00, 0x1c, 0x1e, 0x10, 0x1e, 0x1c, 0x00, 0x00},
+{0x08, 0x1c, 0x2a, 0x08, 0x08, 0x08, 0x00, 0x00},
+{0x00, 0x04, 0x02, 0x3f, 0x02, 0x04, 0x00, 0x00},
+{0x00, 0x00, 0x08, 0x08, 0x08, 0x2a, 0x1c, 0x08},
+{0x00, 0x08, 0x10, 0x3f, 0x10, 0x08, 0x00, 0x00}
+};
+
+static const OLEDFontRange defaultRanges[] PROGMEM = {
+    {10, 10, 1},                    /* Line feed drawn as a space */
+    {32, 126, 1},
+    {0x00B0, 0x00B0, 96},           /* Degree sign */
+    {0x00B5, 0x00B5, 97},
+    {0x00C4, 0x00C4, 98},
+    {0x00C9, 0x00C9, 99},
+    {0x00D6, 0x00D6, 100},
+    {0x00DC, 0x00DC, 101},
+    {0x00E0, 0x00E0, 102},
+    {0x00E2, 0x00E2, 103},
+    {0x00E4, 0x00E4, 104},
+    {0x00E7, 0x00EB, 105},
+    {0x00F1, 0x00F1, 110},
+    {0x00F4, 0x00F4, 111},
+    {0x00F6, 0x00F6, 112},
+    {0x00F9, 0x00F9, 113},
+    {0x00FB, 0x00FC, 114},
+    {0x2190, 0x2193, 116}           /* Arrows */
+};
+
+const OLEDFont defaultFont = {
+    (const byte *)defaultGlyphs, defaultRanges, 18, 8, 8, 0, NULL
+};
+
+
+/* Proportional variant of the default font: glyphs are left aligned and
+ * advance by their ink width plus one column. */
+static const byte propGlyphs[][8] PROGMEM = {
+{0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x06, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x0c, 0x1e, 0x1e, 0x1e, 0x0c, 0x00, 0x00, 0x00},
+{0x16, 0x16, 0x16, 0x16, 0x1e, 0x1e, 0x00, 0x00},
+{0x06, 0x16, 0x16, 0x0e, 0x1c, 0x1e, 0x1e, 0x1c},
+{0x1a, 0x1e, 0x1e, 0x1e, 0x16, 0x00, 0x00, 0x00},
+{0x06, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x3c, 0x3e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x3e, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x04, 0x06, 0x06, 0x04, 0x00, 0x00, 0x00, 0x00},
+{0x08, 0x08, 0x1c, 0x1c, 0x08, 0x00, 0x00, 0x00},
+{0x30, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x10, 0x1c, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x12, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x16, 0x16, 0x16, 0x00, 0x00, 0x00},
+{0x12, 0x16, 0x16, 0x1e, 0x1a, 0x00, 0x00, 0x00},
+{0x0e, 0x0e, 0x08, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x16, 0x16, 0x16, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x16, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x02, 0x12, 0x1a, 0x0e, 0x02, 0x00, 0x00, 0x00},
+{0x1a, 0x1e, 0x16, 0x1e, 0x1a, 0x00, 0x00, 0x00},
+{0x16, 0x16, 0x16, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x14, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x34, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x08, 0x08, 0x08, 0x14, 0x14, 0x00, 0x00, 0x00},
+{0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00},
+{0x14, 0x14, 0x18, 0x08, 0x08, 0x00, 0x00, 0x00},
+{0x02, 0x16, 0x16, 0x06, 0x06, 0x00, 0x00, 0x00},
+{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x0a, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x16, 0x1e, 0x1a, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x12, 0x12, 0x12, 0x12, 0x00, 0x00},
+{0x1e, 0x1e, 0x12, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x16, 0x16, 0x16, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x06, 0x06, 0x02, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x16, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x04, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x10, 0x10, 0x10, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x0c, 0x12, 0x12, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x0c, 0x18, 0x0c, 0x1e, 0x1e, 0x00},
+{0x1e, 0x1e, 0x0c, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x12, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x0a, 0x0e, 0x0e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x12, 0x3e, 0x3e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x06, 0x1e, 0x1a, 0x00, 0x00, 0x00},
+{0x16, 0x16, 0x16, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x02, 0x02, 0x1e, 0x1e, 0x02, 0x02, 0x00, 0x00},
+{0x1e, 0x1e, 0x10, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x02, 0x06, 0x18, 0x18, 0x0e, 0x02, 0x00, 0x00},
+{0x1e, 0x1e, 0x10, 0x1e, 0x1e, 0x10, 0x1e, 0x1e},
+{0x10, 0x1a, 0x0e, 0x0e, 0x1a, 0x10, 0x00, 0x00},
+{0x02, 0x06, 0x1c, 0x1c, 0x06, 0x02, 0x00, 0x00},
+{0x02, 0x12, 0x1a, 0x16, 0x12, 0x12, 0x00, 0x00},
+{0x1e, 0x1e, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x02, 0x06, 0x1c, 0x10, 0x00, 0x00, 0x00, 0x00},
+{0x12, 0x12, 0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00},
+{0x08, 0x0c, 0x06, 0x0e, 0x08, 0x00, 0x00, 0x00},
+{0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00},
+{0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x14, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x14, 0x14, 0x14, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x14, 0x1e, 0x1e, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x06, 0x02, 0x00, 0x00, 0x00, 0x00},
+{0x3c, 0x3c, 0x34, 0x3c, 0x3c, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x04, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x3e, 0x3e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x08, 0x14, 0x10, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x04, 0x1c, 0x1c, 0x04, 0x1c, 0x1c},
+{0x1c, 0x1c, 0x04, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x14, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x3c, 0x3c, 0x14, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x14, 0x3c, 0x3c, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x10, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x04, 0x1c, 0x18, 0x1c, 0x0c, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x10, 0x1c, 0x1c, 0x1c, 0x1c, 0x00},
+{0x14, 0x08, 0x1c, 0x14, 0x00, 0x00, 0x00, 0x00},
+{0x3c, 0x3c, 0x30, 0x3c, 0x3c, 0x00, 0x00, 0x00},
+{0x04, 0x14, 0x1c, 0x1c, 0x14, 0x00, 0x00, 0x00},
+{0x1c, 0x3e, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x3e, 0x3c, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00},
+{0x07, 0x05, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x3c, 0x3c, 0x10, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1e, 0x1f, 0x0a, 0x1f, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1e, 0x17, 0x17, 0x16, 0x00, 0x00, 0x00},
+{0x1e, 0x1f, 0x12, 0x1f, 0x1e, 0x00, 0x00, 0x00},
+{0x1e, 0x1f, 0x10, 0x1f, 0x1e, 0x00, 0x00, 0x00},
+{0x1c, 0x1d, 0x1e, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1e, 0x1d, 0x1e, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1e, 0x1c, 0x1e, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x5c, 0x34, 0x14, 0x14, 0x00, 0x00, 0x00},
+{0x1c, 0x1d, 0x1e, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1c, 0x1e, 0x1d, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1e, 0x1d, 0x1e, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1e, 0x1c, 0x1e, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1e, 0x05, 0x1e, 0x1d, 0x00, 0x00, 0x00},
+{0x1c, 0x1e, 0x15, 0x1e, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1e, 0x14, 0x1e, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1d, 0x12, 0x1c, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1e, 0x11, 0x1e, 0x1c, 0x00, 0x00, 0x00},
+{0x1c, 0x1e, 0x10, 0x1e, 0x1c, 0x00, 0x00, 0x00},
+{0x08, 0x1c, 0x2a, 0x08, 0x08, 0x08, 0x00, 0x00},
+{0x04, 0x02, 0x3f, 0x02, 0x04, 0x00, 0x00, 0x00},
+{0x08, 0x08, 0x08, 0x2a, 0x1c, 0x08, 0x00, 0x00},
+{0x08, 0x10, 0x3f, 0x10, 0x08, 0x00, 0x00, 0x00}
+};
+
+static const byte propWidths[] PROGMEM = {
+    3, 3, 3, 4, 6, 7, 9, 6, 3, 3, 3, 5, 6, 3, 4, 3,
+    4, 6, 3, 6, 6, 6, 6, 6, 6, 6, 6, 3, 3, 6, 6, 6,
+    6, 3, 6, 6, 7, 6, 6, 6, 6, 6, 3, 6, 6, 5, 8, 6,
+    6, 6, 6, 6, 6, 7, 6, 7, 9, 7, 7, 7, 4, 5, 5, 6,
+    6, 3, 6, 6, 6, 6, 6, 5, 6, 6, 3, 3, 6, 3, 9, 6,
+    6, 6, 6, 5, 6, 4, 6, 6, 8, 5, 6, 6, 4, 3, 4, 6,
+    4, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 7, 6, 7, 6
+};
+
+const OLEDFont defaultPropFont = {
+    (const byte *)propGlyphs, defaultRanges, 18, 8, 8, 0, propWidths
+};
+
+
+/* Digits and number signs at 16 pixels high, for headline values. Digits
+ * and space share the same advance so values stay aligned. */
+static const byte digitGlyphs16[][32] PROGMEM = {
+{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x3c, 0x3c, 0x3c, 0x3c, 0x3c, 0x3c, 0xfc, 0xfc, 0xf0, 0xf0, 0xfc, 0xfc, 0xfc, 0xfc, 0xf0, 0xf0,
+ 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03},
+{0xc0, 0xc0, 0xc0, 0xc0, 0xf0, 0xf0, 0xf0, 0xf0, 0xc0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x0f, 0x0f, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0xfc, 0xfc, 0xfc, 0xfc, 0x0c, 0x0c, 0xfc, 0xfc, 0xfc, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x00, 0x00, 0xfc, 0xfc, 0xfc, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0xfc, 0xfc, 0xfc, 0xfc, 0x3c, 0x3c, 0x3c, 0x3c, 0x3c, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x0c, 0x0c, 0x3c, 0x3c, 0x3c, 0x3c, 0xfc, 0xfc, 0xcc, 0xcc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0xfc, 0xfc, 0xfc, 0xfc, 0xc0, 0xc0, 0xfc, 0xfc, 0xfc, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x3c, 0x3c, 0x3c, 0x3c, 0x3c, 0x3c, 0xfc, 0xfc, 0xfc, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0xfc, 0xfc, 0xfc, 0xfc, 0x3c, 0x3c, 0xfc, 0xfc, 0xfc, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x0c, 0x0c, 0x0c, 0x0c, 0xcc, 0xcc, 0xfc, 0xfc, 0x0c, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0xcc, 0xcc, 0xfc, 0xfc, 0x3c, 0x3c, 0xfc, 0xfc, 0xcc, 0xcc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x3c, 0x3c, 0x3c, 0x3c, 0x3c, 0x3c, 0xfc, 0xfc, 0xfc, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+{0x30, 0x30, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+};
+
+static const byte digitWidths16[] PROGMEM = {
+    12, 18, 12, 6, 8, 6, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 6
+};
+
+static const OLEDFontRange digitRanges16[] PROGMEM = {
+    {32,  32,  0},
+    {37,  37,  1},
+    {43,  46,  2},
+    {48,  58,  6}
+};
+
+const OLEDFont digitFont16 = {
+    (const byte *)digitGlyphs16, digitRanges16, 4, 16, 16, 0, digitWidths16
 };
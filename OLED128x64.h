@@ -15,17 +15,103 @@
 #define __OLED128X64_H__
 
 #include <Arduino.h>
+#include <Wire.h>
 #include <functional>
 
 #define OLED_WIDTH                   128
 #define OLED_HEIGHT                  64
 
+/* Uncomment (or build with -DOLED_STATS) to collect I/O statistics */
+//#define OLED_STATS
+
+/* Uncomment (or build with -DOLED_DOUBLE_BUFFER) to send frames from a
+ * front buffer, updated by swap() (W*H/8 more bytes of RAM) */
+//#define OLED_DOUBLE_BUFFER
+
+/* Uncomment (or build with -DOLED_NO_GLOBAL) to leave out the global
+ * 128x64 OLED instance and its buffer, when the sketch declares its own */
+//#define OLED_NO_GLOBAL
+
+/* Bytes the Wire library can hold in a single transmission (control byte
+ * included). AVR cores provide 32 bytes, ESP8266/ESP32 cores 128 bytes. */
+#ifndef OLED_I2C_BUFFER
+#  if defined(BUFFER_LENGTH)
+#    define OLED_I2C_BUFFER          BUFFER_LENGTH
+#  elif defined(I2C_BUFFER_LENGTH)
+#    define OLED_I2C_BUFFER          I2C_BUFFER_LENGTH
+#  else
+#    define OLED_I2C_BUFFER          32
+#  endif
+#endif
+
+/* SPI clock (the SSD1306 accepts up to 10MHz) and unused pin marker */
+#define OLED_SPI_CLOCK               8000000
+#define OLED_NO_PIN                  0xFF
+
+/* Data bytes sent by a poll() call in asynchronous mode */
+#define OLED_POLL_BUDGET             64
+
+/* Displays handled by an OLEDManager */
+#define OLED_MAX_SCREENS             4
+
+/* Longest formatted number, padding included: the digits of a long (at
+ * most 5 per 2 bytes) plus sign, point and the leading zeros of 9 decimals */
+#define OLED_NUMBER_LEN              ((int)sizeof(long)*5/2 + 10)
+
+/* Number fields whose last length is remembered, to blank what a shorter
+ * number leaves behind */
+#define OLED_NUMBER_FIELDS           4
+
+/* Statistics slots, one per group of public calls (see getStats()) */
+#define OLED_STAT_INIT               0
+#define OLED_STAT_DISPLAY            1
+#define OLED_STAT_CLEAR              2
+#define OLED_STAT_PIXEL              3
+#define OLED_STAT_STR                4
+#define OLED_STAT_NUMBER             5
+#define OLED_STAT_IMAGE              6
+#define OLED_STAT_BITMAP             7
+#define OLED_STAT_SHAPE              8
+#define OLED_STAT_WIDGET             9
+#define OLED_STAT_CONSOLE            10
+#define OLED_STAT_SCROLL             11
+#define OLED_STAT_COUNT              12
+
+/* Pixel colors */
+#define OLED_BLACK                   0
+#define OLED_WHITE                   1
+#define OLED_INVERSE                 2
+
+/* Bitmap raster operations */
+#define OLED_ROP_COPY                0
+#define OLED_ROP_OR                  1
+#define OLED_ROP_AND                 2
+#define OLED_ROP_XOR                 3
+#define OLED_ROP_ERASE               4
+#define OLED_ROP_TRANSPARENT         OLED_ROP_OR
+
+/* Picture rotation, clockwise (see setRotation()) */
+#define OLED_ROTATE_0                0
+#define OLED_ROTATE_90               1
+#define OLED_ROTATE_180              2
+#define OLED_ROTATE_270              3
+
+/* Row-major bitmap bit order (see drawBitmapRowMajor()) */
+#define OLED_MSB_FIRST               0
+#define OLED_LSB_FIRST               1
+
+/* Grayscale conversion (see drawGrayRow()) */
+#define OLED_DITHER_THRESHOLD        0
+#define OLED_DITHER_BAYER            1
+#define OLED_DITHER_FLOYD            2
+
 
 /* ============================== Register names ============================ */
 
 #define OLED_ADDRESS                 0x3C
 #define OLED_DATA_MODE               0x40
 #define OLED_CMD_MODE                0x80
+#define OLED_CMD_STREAM              0x00
 #define OLED_NORMALDISPLAY           0xA6
 #define OLED_OFF                     0xAE
 #define OLED_ON                      0xAF
@@ -35,6 +121,8 @@
 #define OLED_STARTLINE               0x40
 #define OLED_CHARGEPUMP              0x8D
 #define OLED_SETMEMORYMODE           0x20
+#define OLED_SETCOLUMNADDR           0x21
+#define OLED_SETPAGEADDR             0x22
 #define OLED_SEGREMAP                0xA0
 #define OLED_COMSCANDEC              0xC8
 #define OLED_COMSCANINC              0xC0
@@ -45,49 +133,430 @@
 #define OLED_DISPLAYALLONRESUME      0xA4
 #define OLED_SCROLLON                0x2F
 #define OLED_SCROLLOFF               0x2E
+#define OLED_RIGHTSCROLL             0x26
+#define OLED_LEFTSCROLL              0x27
+#define OLED_VERTRIGHTSCROLL         0x29
+#define OLED_VERTLEFTSCROLL          0x2A
+#define OLED_SETVERTSCROLLAREA       0xA3
 #define OLED_INVERTDISPLAY           0xA7
 #define OLED_LOWCOLUMN               0x00
 #define OLED_HIGHCOLUMN              0x10
 
 
-class OLED128x64
+/* ========================= Scroll step intervals ========================== */
+
+#define OLED_SCROLL_2FRAMES          0x07
+#define OLED_SCROLL_3FRAMES          0x04
+#define OLED_SCROLL_4FRAMES          0x05
+#define OLED_SCROLL_5FRAMES          0x00
+#define OLED_SCROLL_25FRAMES         0x06
+#define OLED_SCROLL_64FRAMES         0x01
+#define OLED_SCROLL_128FRAMES        0x02
+#define OLED_SCROLL_256FRAMES        0x03
+
+
+#ifdef OLED_STATS
+/**
+ * I/O statistics. Bytes exclude the control byte opening each transaction.
+ * Calls and microseconds are charged to the outermost public call only.
+ */
+struct OLEDStats {
+    unsigned long transactions;
+    unsigned long cmdBytes;
+    unsigned long dataBytes;
+    unsigned long skippedBytes;     /* Not sent thanks to dirty tracking */
+    unsigned long calls[OLED_STAT_COUNT];
+    unsigned long micros[OLED_STAT_COUNT];
+};
+#endif
+
+
+/* Character cells covered by the last number drawn at a position */
+struct OLEDNumberField {
+    byte          row;
+    byte          col;
+    byte          len;              /* 0 for a free entry */
+};
+
+
+/* Consecutive character codes stored in a font */
+struct OLEDFontRange {
+    uint16_t      first;
+    uint16_t      last;
+    uint16_t      offset;           /* Glyph index of the first character */
+};
+
+
+/**
+ * Sparse font: only the listed character ranges have glyphs, other codes
+ * are drawn with the fallback glyph. Glyphs and ranges live in PROGMEM,
+ * ranges sorted by code. A glyph holds width columns for each of its
+ * height/8 pages. Proportional fonts give the advance of each glyph in
+ * widths (PROGMEM), monospace fonts leave it NULL.
+ */
+struct OLEDFont {
+    const byte          *glyphs;
+    const OLEDFontRange *ranges;
+    byte                 rangeCount;
+    byte                 width;
+    byte                 height;
+    uint16_t             fallback;  /* Glyph index */
+    const byte          *widths;
+
+    uint16_t    index(const uint16_t c) const;
+    const byte *glyph(const uint16_t c) const;
+    byte        advance(const uint16_t c) const;
+    int         textWidth(const char *string) const;
+};
+
+extern const OLEDFont defaultFont;
+extern const OLEDFont defaultPropFont;
+extern const OLEDFont digitFont16;
+
+
+/**
+ * Optional bulk transfer hook, e.g. to feed a DMA channel. It must return
+ * once the transfer is complete: the buffer may change and, with SPI, CS
+ * is raised afterwards.
+ *
+ * @param  context    Pointer given to setDmaHook()
+ * @param  address    I2C address of the device, 0 with SPI
+ * @param  data       Bytes to send
+ * @param  len        Number of bytes
+ */
+typedef void (*OLEDDmaHook)(void *context, const byte address,
+                            const byte *data, const int len);
+
+
+/**
+ * I2C transport. A stream of bytes sharing the same control byte is split
+ * into as many transmissions as the Wire buffer allows. Each transmission
+ * is gathered in RAM and sent with a single bulk write, or handed over,
+ * control byte first, to the DMA hook which sends it to getAddress().
+ */
+class OLEDI2C
 {
     public:
-        OLED128x64(const byte address = OLED_ADDRESS);
+        /* Data bytes that fit in a single transmission */
+        static constexpr int      CHUNK = OLED_I2C_BUFFER - 1;
+
+        explicit  OLEDI2C(const byte address = OLED_ADDRESS);
+                  OLEDI2C(const byte address, TwoWire &wire);
 
         void      setAddress(const byte address);
         byte      getAddress();
+        const void *getPort();
+        void      setDmaHook(OLEDDmaHook hook, void *context = NULL);
+        void      begin();
+        void      beginStream(const byte mode);
+        void      write(const byte data);
+        void      write(const byte *data, int len);
+        void      endStream();
+#ifdef OLED_STATS
+        unsigned long transactions;
+#endif
+
+    private:
+        TwoWire    *_wire;
+        OLEDDmaHook _dma;
+        void       *_dmaContext;
+        byte        _address;
+        byte        _len;
+        byte        _buf[OLED_I2C_BUFFER];
+        void        _send();
+};
+
+
+/**
+ * 4-wire hardware SPI transport: the D/C pin selects commands or data and
+ * the optional CS pin frames each stream. Bulk writes go to the DMA hook
+ * when one is set. SPI has no device address.
+ */
+class OLEDSPI
+{
+    public:
+        /* Data bytes sent per step of pollFor() */
+        static constexpr int      CHUNK = 128;
+
+        explicit  OLEDSPI(const byte dc = OLED_NO_PIN,
+                          const byte cs = OLED_NO_PIN,
+                          const unsigned long clock = OLED_SPI_CLOCK);
+
+        void      setAddress(const byte address);
+        byte      getAddress();
+        const void *getPort();
+        void      setDmaHook(OLEDDmaHook hook, void *context = NULL);
+        void      begin();
+        void      beginStream(const byte mode);
+        void      write(const byte data);
+        void      write(const byte *data, int len);
+        void      endStream();
+#ifdef OLED_STATS
+        unsigned long transactions;
+#endif
+
+    private:
+        OLEDDmaHook   _dma;
+        void         *_dmaContext;
+        unsigned long _clock;
+        byte          _dc;
+        byte          _cs;
+};
+
+
+/**
+ * What OLEDManager needs from a display, whatever its geometry and
+ * transport.
+ */
+class OLEDScreen
+{
+    public:
+        virtual void        display() = 0;
+        virtual void        setAsync(const bool val) = 0;
+        virtual bool        isFlushing() = 0;
+        virtual int         flushBudget(const int budget) = 0;
+        virtual const void *getPort() = 0;
+};
+
+
+/**
+ * Flush scheduler for several displays. Screens sharing a bus (same Wire
+ * instance, or SPI) split a per-poll byte budget in turn, so a busy screen
+ * can neither starve the others nor hold the bus longer than the budget.
+ */
+class OLEDManager
+{
+    public:
+                  OLEDManager();
+
+        bool      add(OLEDScreen &screen);
+        void      display();
+        bool      poll(const int budget = OLED_POLL_BUDGET);
+        bool      isFlushing();
+
+    private:
+        OLEDScreen *_screens[OLED_MAX_SCREENS];
+        byte        _count;
+        byte        _next;
+};
+
+
+/**
+ * Driver for a W x H pixels SSD1306 screen. XOFF is the first GDDRAM column
+ * wired to the panel (e.g. 32 on 64x48 modules). BUS is the transport
+ * (OLEDI2C or OLEDSPI). Combinations listed at the end of this file are
+ * instantiated by the library.
+ */
+template <int W, int H, int XOFF = 0, class BUS = OLEDI2C>
+class SSD1306 : public Print, public OLEDScreen
+{
+    public:
+        static constexpr int      WIDTH   = W;
+        static constexpr int      HEIGHT  = H;
+        static constexpr int      PAGES   = H/8;
+
+        SSD1306(const byte address = OLED_ADDRESS);
+        SSD1306(const BUS &bus);
+
+        void      setAddress(const byte address);
+        byte      getAddress();
+        const void *getPort();
+        void      setDmaHook(OLEDDmaHook hook, void *context = NULL);
+        void      setBuffered(const bool val);
+        bool      isBuffered();
+        void      setAsync(const bool val);
+        void      setFlushCallback(void (*callback)());
+        bool      isFlushing();
         void      setInvertedDisplay(const bool val);
-        void      setPixel(const int row, const int col, const bool val);
+        void      setRotation(const byte rotation);
+        byte      getRotation();
+        void      setMirror(const bool x, const bool y);
+        int       getWidth();
+        int       getHeight();
+        void      setPixel(const int row, const int col, const byte color);
         void      setCharCursor(const int X, const int col);
         void      setCursor(const int X, const int Y);
+#ifdef OLED_STATS
+        const OLEDStats &getStats();
+        void      resetStats();
+#endif
 
         void      init();
+        void      display();
+        bool      poll(const int budget = OLED_POLL_BUDGET);
+        int       flushBudget(const int budget);
+#ifdef OLED_DOUBLE_BUFFER
+        bool      swap();
+#endif
+        bool      pollFor(const unsigned long us);
         void      powerOn();
         void      powerOff();
 
+        void      startScrollRight(const int page0, const int page1,
+                                   const byte interval = OLED_SCROLL_5FRAMES);
+        void      startScrollLeft(const int page0, const int page1,
+                                  const byte interval = OLED_SCROLL_5FRAMES);
+        void      startScrollDiagRight(const int page0, const int page1,
+                                       const int offset,
+                                       const byte interval = OLED_SCROLL_5FRAMES);
+        void      startScrollDiagLeft(const int page0, const int page1,
+                                      const int offset,
+                                      const byte interval = OLED_SCROLL_5FRAMES);
+        void      setScrollArea(const int top, const int rows);
+        void      stopScroll();
+        void      scrollBuffer(int page0, int page1, const int dx);
+
+        virtual size_t write(uint8_t c);
+        virtual size_t write(const uint8_t *buffer, size_t size);
+        using     Print::write;
+        virtual void   flush();
+        void      setConsoleCursor(const int X, const int Y);
+
         void      clear();
         void      clearCharRow(const int X);
         void      clearChar(const int X, const int Y);
 
         void      drawStr(const char *string, int X, int Y);
+        void      drawStr(const char *string, int X, int Y,
+                          const OLEDFont &font);
         void      drawStr(const char *string, int X, int Y,
                           const char font[256][8]);
+        int       drawText(const char *string, const int x, const int y);
+        int       drawText(const char *string, const int x, const int y,
+                           const OLEDFont &font,
+                           const byte rop = OLED_ROP_COPY);
+        void      drawInt(const long value, const int X, const int Y,
+                          const int width = 0);
+        void      drawFixed(const long value, int decimals,
+                            const int X, const int Y, const int width = 0);
+        void      drawFloat(const float value, int decimals,
+                            const int X, const int Y, const int width = 0);
         void      drawImage(const char *data);
+        void      drawImageRLE(const char *data);
+        void      drawBitmap(const int x, const int y, const int w,
+                             const int h, const char *data,
+                             const byte rop = OLED_ROP_COPY);
+        void      drawBitmapRLE(const int x, const int y, const int w,
+                                const int h, const char *data,
+                                const byte rop = OLED_ROP_COPY);
+        void      drawBitmapRowMajor(const int x, const int y, const int w,
+                                     const int h, const char *data,
+                                     const byte rop = OLED_ROP_COPY,
+                                     const byte order = OLED_MSB_FIRST);
+        void      drawGrayRow(const int x, const int y, const int w,
+                              const byte *row, const byte dither,
+                              int16_t *err = NULL);
+        void      drawGray(const int x, const int y, const int w,
+                           const int h, const byte *pixels,
+                           const byte dither, int16_t *err = NULL);
         void      drawHLine(const int Y);
         void      drawVLine(const int X);
         void      drawProgressBar(const int Y, const int percent);
+        void      drawLevelMeter(const int x, const int y, const int w,
+                                 const int h, int percent);
+        void      drawSpinner(const int X, const int Y,
+                              const unsigned int phase);
+        void      drawLine(int x0, int y0, const int x1, const int y1,
+                           const byte color = OLED_WHITE);
+        void      drawRect(const int x, const int y, const int w,
+                           const int h, const byte color = OLED_WHITE);
+        void      fillRect(const int x, const int y, const int w,
+                           const int h, const byte color = OLED_WHITE);
+        void      drawCircle(const int cx, const int cy, const int r,
+                             const byte color = OLED_WHITE);
+        void      fillCircle(const int cx, const int cy, const int r,
+                             const byte color = OLED_WHITE);
 
     private:
-        byte      _address;
-        void      _write(const byte data, const byte mode);
+        BUS       _bus;
+        void      _beginStream(const byte mode);
+        void      _stream(const byte data);
+        void      _streamBuf(const byte *data, const int len);
+        void      _endStream();
+        void      _streamP(const byte *data, const int len);
         void      _clearBuffer();
-        void      _clearScreen();
         void      _clearCharBuffer(const int X, const int Y);
-        void      _clearCharScreen(const int X, const int Y);
-        byte      _buffer[OLED_WIDTH][OLED_HEIGHT/8];
+        int       _numberField(const int X, const int Y, const int len);
+        void      _markDirty(const int page0, const int page1,
+                             const int col0, const int col1);
+        byte     *_page(const int page);
+        byte     *_frontPage(const int page);
+#ifdef OLED_DOUBLE_BUFFER
+        void      _diffPage(const int page);
+#endif
+        void      _invalidate(const int page0, const int page1);
+        void      _putByte(const int page, const int col, const byte value);
+        void      _applyMask(const int page, const int col, const byte mask,
+                             const byte color);
+        void      _plot(const int x, const int y, const byte color);
+        void      _fill(int x0, int y0, int x1, int y1, const byte color);
+        void      _grayRow(const int x, const int y, const int w,
+                           const byte *row, const byte dither, int16_t *err);
+        void      _blitByte(const int x, const int y, const byte bits,
+                            const int n, const byte rop);
+        void      _update();
+        void      _consoleByte(const byte b);
+        void      _consoleChar(const uint16_t c);
+        void      _consoleNewLine();
+        void      _startScroll(const byte cmd, const int page0,
+                               const int page1, const int offset,
+                               const byte interval);
+        int       _flush(int budget);
+        int       _flushRotated(int budget);
+        void      _streamOrientation();
+        void      _resetFrame();
+        void      _flushStartLine();
+        bool      _buffered;
+        bool      _async;
+        byte      _scrollFrom;
+        byte      _scrollTo;
+        byte      _conRow;
+        byte      _conCol;
+        byte      _conTop;
+        byte      _startTop;        /* Console top queued by display() */
+        byte      _shownTop;        /* Console top on the panel */
+        byte      _conMore;
+        uint16_t  _conCode;
+        OLEDNumberField _fields[OLED_NUMBER_FIELDS];
+        byte      _nextField;
+        void    (*_onFlushed)();
+
+        /* COM pins configuration: sequential on wide panels (128x32) */
+        static constexpr byte     COMPINS = (W > 2*H) ? 0x02 : 0x12;
+        /* Buffer pages in portrait orientation */
+        static constexpr int      MAXPAGES = ((W > H) ? W : H)/8;
+        byte      _rotation;
+        bool      _mirrorX;
+        bool      _mirrorY;
+        byte      _width;
+        byte      _height;
+        byte      _pages;
+        byte      _xoff;
+        byte      _buffer[W*H/8];     /* Page-major, _pages x _width */
+#ifdef OLED_DOUBLE_BUFFER
+        byte      _front[W*H/8];      /* Content of the screen */
+        bool      _stale[MAXPAGES];   /* Pages to send whole */
+#endif
+        byte      _dirtyFrom[MAXPAGES];
+        byte      _dirtyTo[MAXPAGES];
+        byte      _pendingFrom[MAXPAGES];
+        byte      _pendingTo[MAXPAGES];
+#ifdef OLED_STATS
+        OLEDStats _stats;
+        byte      _statDepth;
+#endif
 };
 
+typedef SSD1306<128, 64>             OLED128x64;
+typedef SSD1306<128, 32>             OLED128x32;
+typedef SSD1306<96, 16>              OLED96x16;
+typedef SSD1306<72, 40, 28>          OLED72x40;
+typedef SSD1306<64, 48, 32>          OLED64x48;
+typedef SSD1306<64, 32, 32>          OLED64x32;
+typedef SSD1306<128, 64, 0, OLEDSPI> OLED128x64SPI;
+typedef SSD1306<128, 32, 0, OLEDSPI> OLED128x32SPI;
+
+#ifndef OLED_NO_GLOBAL
 extern OLED128x64 OLED;
-extern const char defaultFont[][8];
+#endif
 #endif
@@ -0,0 +1,105 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino core stand-in to build the library on a Linux host.
+ * @author Jean-Yves VET
+ */
+
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define PROGMEM
+#define pgm_read_byte(addr)          (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)          (*(const uint16_t *)(addr))
+#define memcpy_P                     memcpy
+
+#define DEC                          10
+#define HEX                          16
+
+#define LOW                          0
+#define HIGH                         1
+#define INPUT                        0
+#define OUTPUT                       1
+
+unsigned long micros();
+unsigned long millis();
+void          pinMode(const byte pin, const byte mode);
+void          digitalWrite(const byte pin, const byte level);
+int           digitalRead(const byte pin);
+
+/* Host only: advance the modelled time by a bus transfer */
+void          hostElapse(const double us);
+
+
+/* Subset of the Arduino Print class */
+class Print
+{
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t c) = 0;
+
+        virtual size_t write(const uint8_t *buffer, size_t size) {
+            size_t n = 0;
+            while (size--) n += write(*buffer++);
+            return n;
+        }
+
+        virtual void flush() {}
+
+        size_t print(const char *s) {
+            return write((const uint8_t *)s, strlen(s));
+        }
+
+        size_t print(char c) {
+            return write((uint8_t)c);
+        }
+
+        size_t print(long n, int base = DEC) {
+            char   buf[34], *p = buf + sizeof(buf) - 1;
+            bool   neg = n < 0 && base == DEC;
+            unsigned long u = neg ? -(unsigned long)n : (unsigned long)n;
+
+            *p = '\0';
+            do {
+                int d = u % base;
+                *--p = d < 10 ? '0' + d : 'A' + d - 10;
+                u /= base;
+            } while (u);
+            if (neg) *--p = '-';
+            return print(p);
+        }
+
+        size_t print(int n, int base = DEC) {
+            return print((long)n, base);
+        }
+
+        size_t println() {
+            return print("\r\n");
+        }
+
+        template <typename T>
+        size_t println(T value) {
+            size_t n = print(value);
+            return n + println();
+        }
+};
+
+#endif
@@ -0,0 +1,96 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file SPI.cpp
+ * @brief Simulated 4-wire SPI bus decoding the SSD1306 protocol on a Linux
+ *        host.
+ * @author Jean-Yves VET
+ */
+
+#include <SPI.h>
+
+
+SPIClass::SPIClass() {
+    _clock = 4000000;
+    _dc = _cs = 0xFF;
+    panel.reset();
+    resetStats();
+}
+
+
+void SPIClass::begin() {
+}
+
+
+/**
+ * Wire the simulated panel: which pins carry D/C and CS.
+ *
+ * @param  dc      Data/command pin
+ * @param  cs      Chip select pin, 0xFF if tied low
+ */
+void SPIClass::attach(const byte dc, const byte cs) {
+    _dc = dc;
+    _cs = cs;
+}
+
+
+void SPIClass::beginTransaction(const SPISettings &settings) {
+    _clock = settings.clock;
+}
+
+
+/**
+ * Clock a byte into the panel if it is selected. D/C high means data.
+ *
+ * @param  data    Byte to send
+ * @return 0 (the panel does not answer)
+ */
+byte SPIClass::transfer(const byte data) {
+    hostElapse(8 * 1e6 / _clock);
+    if (_cs != 0xFF && digitalRead(_cs) != LOW) return 0;
+
+    stats.bytes++;
+    if (digitalRead(_dc) == HIGH) {
+        panel.data(data);
+        stats.dataBytes++;
+    } else {
+        panel.command(data);
+        stats.cmdBytes++;
+    }
+    return 0;
+}
+
+
+void SPIClass::endTransaction() {
+    stats.transactions++;
+}
+
+
+void SPIClass::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+
+/**
+ * Bus time of the counted traffic: 8 clocks per byte.
+ *
+ * @param  hz      Bus clock
+ * @return microseconds
+ */
+double SPIClass::busMicros(const unsigned long hz) {
+    return stats.bytes * 8.0 * 1e6 / hz;
+}
+
+
+SPIClass SPI;
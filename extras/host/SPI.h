@@ -0,0 +1,65 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file SPI.h
+ * @brief Simulated 4-wire SPI bus decoding the SSD1306 protocol on a Linux
+ *        host.
+ * @author Jean-Yves VET
+ */
+
+#ifndef __HOST_SPI_H__
+#define __HOST_SPI_H__
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define MSBFIRST                     1
+#define SPI_MODE0                    0
+
+
+class SPISettings
+{
+    public:
+        SPISettings(const unsigned long clock, const byte order,
+                    const byte mode) : clock(clock) { (void)order; (void)mode; }
+
+        unsigned long clock;
+};
+
+
+class SPIClass
+{
+    public:
+        SPIClass();
+
+        void      begin();
+        void      attach(const byte dc, const byte cs);
+        void      beginTransaction(const SPISettings &settings);
+        byte      transfer(const byte data);
+        void      endTransaction();
+
+        void      resetStats();
+        double    busMicros(const unsigned long hz);
+
+        SimPanel  panel;
+        SimStats  stats;
+
+    private:
+        unsigned long _clock;
+        byte      _dc;
+        byte      _cs;
+};
+
+extern SPIClass SPI;
+#endif
@@ -0,0 +1,326 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file Wire.cpp
+ * @brief Simulated I2C bus decoding the SSD1306 protocol on a Linux host.
+ * @author Jean-Yves VET
+ */
+
+#include <Wire.h>
+
+
+/* Modelled time: bus transfers since start-up */
+static double             elapsed = 0;
+static unsigned long      busClock = 100000;
+static byte               pins[256];
+
+
+/* ============================ Arduino core ================================ */
+
+/**
+ * Modelled time: duration of the bus transfers so far.
+ *
+ * @return  microseconds since start-up
+ */
+unsigned long micros() {
+    return (unsigned long)elapsed;
+}
+
+
+void hostElapse(const double us) {
+    elapsed += us;
+}
+
+
+/**
+ * Modelled time in milliseconds.
+ *
+ * @return  milliseconds since start-up
+ */
+unsigned long millis() {
+    return micros() / 1000;
+}
+
+
+void pinMode(const byte, const byte) {
+}
+
+
+void digitalWrite(const byte pin, const byte level) {
+    pins[pin] = level;
+}
+
+
+int digitalRead(const byte pin) {
+    return pins[pin];
+}
+
+
+/* ============================ Simulated panel ============================= */
+
+/**
+ * Number of argument bytes following a command.
+ *
+ * @param  cmd     Command byte
+ * @return number of arguments
+ */
+static byte argCount(const byte cmd) {
+    switch (cmd) {
+        case 0x26: case 0x27:                       return 6;
+        case 0x29: case 0x2A:                       return 5;
+        case 0x21: case 0x22: case 0xA3:            return 2;
+        case 0x20: case 0x81: case 0x8D: case 0xA8:
+        case 0xD3: case 0xD5: case 0xD9: case 0xDA:
+        case 0xDB:                                  return 1;
+        default:                                    return 0;
+    }
+}
+
+
+/**
+ * Power-on reset state.
+ */
+void SimPanel::reset() {
+    memset(ram, 0, sizeof(ram));
+    col = colStart = 0;
+    colEnd = 127;
+    page = pageStart = 0;
+    pageEnd = 7;
+    memMode = 2;
+    startLine = 0;
+    multiplex = 63;
+    segRemap = comScanDec = inverted = on = scrolling = false;
+    memset(scrollSetup, 0, sizeof(scrollSetup));
+    cmdLen = cmdNeed = 0;
+}
+
+
+/**
+ * Decode a command byte, gathering arguments of multi-byte commands.
+ *
+ * @param  b       Command or argument byte
+ */
+void SimPanel::command(const byte b) {
+    byte c;
+
+    if (cmdLen == 0) {
+        cmdNeed = argCount(b);
+    }
+    cmd[cmdLen++] = b;
+    if (cmdLen <= cmdNeed) return;
+    cmdLen = 0;
+
+    c = cmd[0];
+    if (c < 0x10) {
+        col = (col & 0xF0) | c;
+    } else if (c < 0x20) {
+        col = (col & 0x0F) | ((c & 0x0F) << 4);
+    } else if (c >= 0x40 && c < 0x80) {
+        startLine = c & 0x3F;
+    } else if (c >= 0xB0 && c < 0xB8) {
+        page = c & 0x07;
+    } else {
+        switch (c) {
+            case 0x20: memMode = cmd[1] & 0x03;                        break;
+            case 0x21: colStart  = col  = cmd[1]; colEnd  = cmd[2];    break;
+            case 0x22: pageStart = page = cmd[1]; pageEnd = cmd[2];    break;
+            case 0x26: case 0x27: case 0x29: case 0x2A:
+                memcpy(scrollSetup, cmd, 7);                           break;
+            case 0x2E: scrolling = false;                              break;
+            case 0x2F: scrolling = true;                               break;
+            case 0xA0: segRemap = false;                               break;
+            case 0xA1: segRemap = true;                                break;
+            case 0xA6: inverted = false;                               break;
+            case 0xA7: inverted = true;                                break;
+            case 0xA8: multiplex = cmd[1];                             break;
+            case 0xAE: on = false;                                     break;
+            case 0xAF: on = true;                                      break;
+            case 0xC0: comScanDec = false;                             break;
+            case 0xC8: comScanDec = true;                              break;
+        }
+    }
+}
+
+
+/**
+ * Store a data byte in GDDRAM and advance the address pointer.
+ *
+ * @param  b       Data byte
+ */
+void SimPanel::data(const byte b) {
+    ram[page & 7][col & 127] = b;
+
+    if (memMode == 0) {
+        if (col++ >= colEnd) {
+            col = colStart;
+            if (page++ >= pageEnd) page = pageStart;
+        }
+    } else if (memMode == 1) {
+        if (page++ >= pageEnd) {
+            page = pageStart;
+            if (col++ >= colEnd) col = colStart;
+        }
+    } else if (col < 127) {
+        col++;
+    }
+}
+
+
+/**
+ * Pixel as seen by the user. The init() defaults (segment remap and COM
+ * scan decrement) show GDDRAM upright.
+ *
+ * @param  x       Column [0 to 127]
+ * @param  y       Row [0 to multiplex]
+ * @return true if the pixel is lit
+ */
+bool SimPanel::pixel(const int x, const int y) {
+    int c = segRemap ? x : 127 - x;
+    int r = comScanDec ? y : multiplex - y;
+
+    r = (r + startLine) & 63;
+    return ((ram[r/8][c] >> (r%8)) & 1) != inverted;
+}
+
+
+/* ============================ Simulated bus =============================== */
+
+TwoWire::TwoWire() {
+    _len   = 0;
+    _count = 0;
+    resetStats();
+}
+
+
+void TwoWire::begin() {
+}
+
+
+void TwoWire::setClock(const unsigned long hz) {
+    busClock = hz;
+}
+
+
+void TwoWire::beginTransmission(const byte address) {
+    _address = address;
+    _len = 0;
+}
+
+
+/**
+ * Queue a byte, refusing it when the buffer is full like the AVR core.
+ *
+ * @param  data    Byte to queue
+ * @return number of bytes queued
+ */
+size_t TwoWire::write(const byte data) {
+    if (_len == BUFFER_LENGTH) {
+        stats.overflows++;
+        return 0;
+    }
+    _buffer[_len++] = data;
+    return 1;
+}
+
+
+/**
+ * Queue bytes, refusing those that do not fit like the AVR core.
+ *
+ * @param  data    Bytes to queue
+ * @param  len     Number of bytes
+ * @return number of bytes queued
+ */
+size_t TwoWire::write(const byte *data, const size_t len) {
+    size_t i;
+
+    for (i = 0; i < len && write(data[i]); i++);
+    return i;
+}
+
+
+/**
+ * Send the transmission: decode control bytes and feed the panel.
+ *
+ * @return 0 (success)
+ */
+byte TwoWire::endTransmission() {
+    SimPanel *p = panel(_address);
+    bool      co = true, dc = false;
+    int       i = 0;
+
+    stats.transactions++;
+    stats.bytes += _len;
+    hostElapse((2 + 9 * (1 + _len)) * 1e6 / busClock);
+
+    while (i < _len) {
+        byte ctrl = _buffer[i++];
+        co = ctrl & 0x80;
+        dc = ctrl & 0x40;
+
+        while (i < _len) {
+            if (dc) {
+                p->data(_buffer[i++]);
+                stats.dataBytes++;
+            } else {
+                p->command(_buffer[i++]);
+                stats.cmdBytes++;
+            }
+            if (co) break;
+        }
+    }
+
+    _len = 0;
+    return 0;
+}
+
+
+/**
+ * Panel answering at an address, created on first use.
+ *
+ * @param  address   I2C address
+ * @return panel state
+ */
+SimPanel *TwoWire::panel(const byte address) {
+    int i;
+
+    for (i = 0; i < _count; i++) {
+        if (_panels[i].address == address) return &_panels[i];
+    }
+    if (_count == SIM_MAX_PANELS) return &_panels[0];
+
+    _panels[_count].reset();
+    _panels[_count].address = address;
+    return &_panels[_count++];
+}
+
+
+void TwoWire::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+
+/**
+ * Bus time of the counted traffic: start, address, payload (9 bits per
+ * byte with ACK) and stop for every transaction.
+ *
+ * @param  hz      Bus clock
+ * @return microseconds
+ */
+double TwoWire::busMicros(const unsigned long hz) {
+    double bits = stats.transactions * (2.0 + 9.0) + stats.bytes * 9.0;
+    return bits * 1e6 / hz;
+}
+
+
+TwoWire Wire;
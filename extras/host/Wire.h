@@ -0,0 +1,93 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file Wire.h
+ * @brief Simulated I2C bus decoding the SSD1306 protocol on a Linux host.
+ * @author Jean-Yves VET
+ */
+
+#ifndef __HOST_WIRE_H__
+#define __HOST_WIRE_H__
+
+#include <Arduino.h>
+
+/* Same transmission buffer as the AVR core */
+#define BUFFER_LENGTH                32
+#define SIM_MAX_PANELS               4
+
+
+/* Bus traffic counters */
+struct SimStats {
+    unsigned long transactions;
+    unsigned long bytes;             /* Control, command and data bytes */
+    unsigned long cmdBytes;
+    unsigned long dataBytes;
+    unsigned long overflows;         /* Bytes refused by a full buffer  */
+};
+
+
+/* SSD1306 controller state and 128x64 GDDRAM */
+struct SimPanel {
+    byte      address;
+    byte      ram[8][128];
+    byte      col, colStart, colEnd;
+    byte      page, pageStart, pageEnd;
+    byte      memMode;
+    byte      startLine;
+    byte      multiplex;
+    bool      segRemap;
+    bool      comScanDec;
+    bool      inverted;
+    bool      on;
+    bool      scrolling;
+    byte      scrollSetup[7];
+    byte      cmd[8];
+    byte      cmdLen;
+    byte      cmdNeed;
+
+    void      reset();
+    void      command(const byte b);
+    void      data(const byte b);
+    bool      pixel(const int x, const int y);
+};
+
+
+class TwoWire
+{
+    public:
+        TwoWire();
+
+        void      begin();
+        void      setClock(const unsigned long hz);
+        void      beginTransmission(const byte address);
+        size_t    write(const byte data);
+        size_t    write(const byte *data, const size_t len);
+        byte      endTransmission();
+
+        SimPanel *panel(const byte address);
+        void      resetStats();
+        double    busMicros(const unsigned long hz);
+
+        SimStats  stats;
+
+    private:
+        byte      _address;
+        byte      _buffer[BUFFER_LENGTH];
+        int       _len;
+        SimPanel  _panels[SIM_MAX_PANELS];
+        int       _count;
+};
+
+extern TwoWire Wire;
+#endif
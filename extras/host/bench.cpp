@@ -0,0 +1,1180 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file bench.cpp
+ * @brief Bus traffic benchmark of the library against the simulated panel.
+ *        Every workload checks the resulting GDDRAM against a golden image.
+ * @author Jean-Yves VET
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <Wire.h>
+#include <SPI.h>
+#include "OLED128x64.h"
+
+
+static byte golden[8][128];
+static byte image[OLED_WIDTH*OLED_HEIGHT/8];
+static int  failures = 0;
+
+
+/* ============================ Golden images =============================== */
+
+static void goldenClear() {
+    memset(golden, 0, sizeof(golden));
+}
+
+
+static void goldenStr(const char *string, const int X, const int Y) {
+    int col = 8*Y, i;
+
+    for (; *string && col < 128; string++) {
+        for (i = 0; i < 8; i++) {
+            golden[X][col++] = pgm_read_byte(defaultFont.glyph((byte)*string) + i);
+        }
+    }
+}
+
+
+static void goldenGlyphs(const uint16_t *codes, const int n, const int X,
+                         int col) {
+    int i, j;
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < 8; j++) {
+            golden[X][col++] = pgm_read_byte(defaultFont.glyph(codes[i]) + j);
+        }
+    }
+}
+
+
+static void goldenText(const char *string, int x, const int y,
+                       const OLEDFont &font) {
+    int i, j;
+
+    for (; *string; x += font.advance((byte)*string++)) {
+        const byte *glyph = font.glyph((byte)*string);
+
+        for (i = 0; i < font.advance((byte)*string); i++) {
+            for (j = 0; j < font.height; j++) {
+                int  px = x + i, py = y + j;
+                bool on = i < font.width &&
+                          (glyph[(j/8)*font.width + i] >> (j%8)) & 1;
+
+                if (px < 0 || px >= 128 || py < 0 || py >= 64) continue;
+                if (on) golden[py/8][px] |=  (1 << (py%8));
+                else    golden[py/8][px] &= ~(1 << (py%8));
+            }
+        }
+    }
+}
+
+
+static void goldenProgressBar(const int X, const int percent) {
+    int i;
+
+    golden[X][12] = golden[X][113] = 0x7E;
+    for (i = 0; i < 100; i++) {
+        golden[X][13+i] = (percent >= i) ? 0x7E : 0x42;
+    }
+}
+
+
+static void goldenPixel(const int row, const int col) {
+    golden[row/8][col] |= 1 << (row%8);
+}
+
+
+static void goldenFill(const int x0, const int y0, const int x1,
+                       const int y1) {
+    int x, y;
+
+    for (y = y0; y <= y1; y++) {
+        for (x = x0; x <= x1; x++) {
+            goldenPixel(y, x);
+        }
+    }
+}
+
+
+static void goldenDisc(const int cx, const int cy, const int r) {
+    int x, y;
+
+    for (y = cy - r; y <= cy + r; y++) {
+        for (x = cx - r; x <= cx + r; x++) {
+            if ((x-cx)*(x-cx) + (y-cy)*(y-cy) <= r*r + r) goldenPixel(y, x);
+        }
+    }
+}
+
+
+static void goldenBitmap(const int x, const int y, const int w, const int h,
+                         const byte *data, const int rop) {
+    int i, j;
+
+    for (j = 0; j < h; j++) {
+        for (i = 0; i < w; i++) {
+            int  px = x + i, py = y + j;
+            bool src = (data[(j/8)*w + i] >> (j%8)) & 1;
+            byte bit, *dst;
+
+            if (px < 0 || px >= 128 || py < 0 || py >= 64) continue;
+            bit = 1 << (py%8);
+            dst = &golden[py/8][px];
+
+            switch (rop) {
+                case OLED_ROP_COPY:  *dst = src ? *dst | bit : *dst & ~bit; break;
+                case OLED_ROP_OR:    if (src) *dst |= bit;                  break;
+                case OLED_ROP_AND:   if (!src) *dst &= ~bit;                break;
+                case OLED_ROP_XOR:   if (src) *dst ^= bit;                  break;
+                case OLED_ROP_ERASE: if (src) *dst &= ~bit;                 break;
+            }
+        }
+    }
+}
+
+
+/* ============================ Workloads =================================== */
+
+static void begin() {
+    Wire.resetStats();
+}
+
+
+static void end(const char *name, const byte address = OLED_ADDRESS,
+                const bool valid = true) {
+    SimPanel *panel = Wire.panel(address);
+    bool      ok = valid && memcmp(panel->ram, golden, sizeof(golden)) == 0;
+
+    if (!ok || Wire.stats.overflows) failures++;
+
+    printf("%-28s %7lu %7lu %9.2f %9.2f %9.2f  %s\n", name,
+           Wire.stats.transactions, Wire.stats.bytes,
+           Wire.busMicros(100000) / 1000.0, Wire.busMicros(400000) / 1000.0,
+           Wire.busMicros(1000000) / 1000.0,
+           Wire.stats.overflows ? "OVERFLOW" : (ok ? "ok" : "MISMATCH"));
+}
+
+
+static void benchInit() {
+    begin();
+    OLED.init();
+    goldenClear();
+    end("init");
+}
+
+
+static void benchClear() {
+    OLED.drawStr("dirty", 0, 0);
+    begin();
+    OLED.clear();
+    goldenClear();
+    end("clear");
+}
+
+
+static void benchDrawStr() {
+    const char *line = "0123456789ABCDEF";
+    int         X, i;
+
+    OLED.clear();
+    goldenClear();
+    begin();
+    for (X = 0; X < 8; X++) {
+        OLED.drawStr(line, X, 0);
+        goldenStr(line, X, 0);
+    }
+    end("drawStr (8 rows x 16)");
+
+    begin();
+    OLED.drawStr("42", 3, 7);
+    goldenStr("42", 3, 7);
+    end("drawStr (2 chars)");
+
+    begin();
+    OLED.drawStr("\x01\xC8", 5, 14);
+    for (i = 0; i < 16; i++) {
+        golden[5][112 + i] = (i % 8 == 3 || i % 8 == 4) ? 0x1F : 0x00;
+    }
+    end("drawStr (missing glyphs)");
+}
+
+
+static void benchUtf8() {
+    static const uint16_t line[]    = {'2', '5', 0xB0, 'C', ' ', 0x2192,
+                                       ' ', 0xB5, 's'};
+    static const uint16_t accents[] = {0xE9, 0xE8, 0xE0, 0xE7, 0xFC, 0xC9,
+                                       0xFFFD, 'x', 0xFFFD};
+    static const uint16_t console[] = {0xE9, 't', 0xE9, ' ', 0x2191};
+    const char *text = "\xC3\xA9t\xC3\xA9 \xE2\x86\x91";
+    int i;
+
+    OLED.clear();
+    goldenClear();
+    begin();
+    OLED.drawStr("25\xC2\xB0""C \xE2\x86\x92 \xC2\xB5s", 1, 0);
+    OLED.drawStr("\xC3\xA9\xC3\xA8\xC3\xA0\xC3\xA7\xC3\xBC\xC3\x89"
+                 "\xF0\x9F\x98\x80x\xC3", 2, 0);
+    for (i = 0; text[i]; i++) {
+        OLED.write((uint8_t)text[i]);
+    }
+    goldenGlyphs(line, 9, 1, 0);
+    goldenGlyphs(accents, 9, 2, 0);
+    goldenGlyphs(console, 5, 0, 0);
+    end("UTF-8 drawStr + console");
+}
+
+
+static void goldenSet(const int x, const int y, const bool on) {
+    if (x < 0 || x >= 128 || y < 0 || y >= 64) return;
+    if (on) golden[y/8][x] |=  (1 << (y%8));
+    else    golden[y/8][x] &= ~(1 << (y%8));
+}
+
+
+/* Reference Floyd-Steinberg on the whole image, error of every pixel kept */
+static void goldenFloyd(const int x0, const int y0, const int w, const int h,
+                        const byte *pixels) {
+    static int err[70][130];
+    int i, j, v, e;
+
+    memset(err, 0, sizeof(err));
+    for (j = 0; j < h; j++) {
+        for (i = 0; i < w; i++) {
+            v = pixels[j*w + i] + err[j][i+1];
+            e = v - (v >= 128 ? 255 : 0);
+            goldenSet(x0 + i, y0 + j, v >= 128);
+
+            err[j][i+2]   += e * 7 / 16;
+            err[j+1][i]   += e * 3 / 16;
+            err[j+1][i+1] += e * 5 / 16;
+            err[j+1][i+2] += e / 16;
+        }
+    }
+}
+
+
+static void benchGray() {
+    static const byte bayer[4][4] = {
+        {0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}
+    };
+    static byte    gray[40*100];
+    static int16_t err[101];
+    int i, j;
+
+    for (j = 0; j < 40; j++) {
+        for (i = 0; i < 100; i++) {
+            gray[j*100 + i] = (byte)((i * 255 / 99 + j * 3) & 0xFF);
+        }
+    }
+
+    OLED.clear();
+    goldenClear();
+    begin();
+    OLED.drawGray(-6, 3, 100, 40, gray, OLED_DITHER_FLOYD, err);
+    goldenFloyd(-6, 3, 100, 40, gray);
+    end("drawGray 100x40 (Floyd)");
+
+    OLED.clear();
+    goldenClear();
+    begin();
+    for (j = 0; j < 40; j++) {
+        OLED.drawGrayRow(30, 20 + j, 100, &gray[j*100], OLED_DITHER_BAYER);
+        for (i = 0; i < 100; i++) {
+            goldenSet(30 + i, 20 + j,
+                      gray[j*100 + i] >= bayer[(20+j)&3][(30+i)&3] * 16 + 8);
+        }
+    }
+    OLED.display();
+    end("drawGrayRow x40 (Bayer)");
+
+    OLED.clear();
+    goldenClear();
+    begin();
+    for (j = 0; j < 40; j++) {
+        OLED.drawGrayRow(0, 24 + j, 100, &gray[j*100], OLED_DITHER_THRESHOLD);
+        for (i = 0; i < 100; i++) {
+            goldenSet(i, 24 + j, gray[j*100 + i] >= 128);
+        }
+    }
+    end("drawGrayRow x40 (threshold)");
+}
+
+
+static void benchDrawImage() {
+    int i;
+
+    for (i = 0; i < (int)sizeof(image); i++) {
+        image[i] = (byte)(i * 7 + (i >> 7));
+    }
+
+    begin();
+    OLED.drawImage((const char *)image);
+    memcpy(golden, image, sizeof(golden));
+    end("drawImage");
+}
+
+
+static void benchProgressBar() {
+    int percent;
+
+    OLED.clear();
+    goldenClear();
+    begin();
+    for (percent = 0; percent <= 100; percent++) {
+        OLED.drawProgressBar(4, percent);
+    }
+    goldenProgressBar(4, 100);
+    end("drawProgressBar (0..100%)");
+}
+
+
+static void benchText() {
+    int right;
+
+    OLED.clear();
+    goldenClear();
+    OLED.setBuffered(true);
+    begin();
+    right = OLED.drawText("Proportional text, 21+ chars", -2, 3);
+    OLED.drawText("-12.5%", 30, 21, digitFont16);
+    OLED.drawText("88:05", 60, 50, digitFont16);
+    OLED.display();
+    OLED.setBuffered(false);
+    goldenText("Proportional text, 21+ chars", -2, 3, defaultPropFont);
+    goldenText("-12.5%", 30, 21, digitFont16);
+    goldenText("88:05", 60, 50, digitFont16);
+    end("drawText (8px prop + 16px)", OLED_ADDRESS,
+        right == -2 + defaultPropFont.textWidth("Proportional text, 21+ chars"));
+}
+
+
+static void benchWidgets() {
+    static const byte spinner[8] = {0x00, 0x00, 0x00, 0x7E, 0x7E, 0x00, 0x00, 0x00};
+    static const char dense[256][8] = {{0}};
+    int i;
+
+    OLED.clear();
+    goldenClear();
+    begin();
+    for (i = 0; i <= 100; i++) {
+        OLED.drawLevelMeter(100, 8, 12, 48, i);
+        OLED.drawSpinner(0, 0, i);
+    }
+    goldenFill(100, 8, 111, 55);
+    memcpy(golden[0], spinner, 8);
+    end("level meter + spinner x101");
+
+    /* Out of range rows and columns are ignored */
+    begin();
+    for (i = 0; i < 2; i++) {
+        int X = i ? 8 : -1;
+
+        OLED.drawStr("oops", X, 0);
+        OLED.drawStr("oops", 0, -1);
+        OLED.drawStr("oops", X, 0, dense);
+        OLED.drawStr("oops", 0, -1, dense);
+        OLED.drawProgressBar(X, 50);
+        OLED.clearCharRow(X);
+        OLED.clearChar(X, 0);
+        OLED.clearChar(0, i ? 16 : -1);
+        OLED.drawSpinner(X, 0, 1);
+        OLED.drawSpinner(0, i ? 16 : -1, 1);
+    }
+    end("widgets (out of range)");
+}
+
+
+static void benchNumbers() {
+    char text[24];
+    int  i;
+
+    OLED.clear();
+    goldenClear();
+    begin();
+    for (i = 0; i <= 1000; i++) {
+        OLED.drawInt(i, 2, 0, 6);
+    }
+    OLED.drawFixed(-5, 2, 3, 0, 6);
+    OLED.drawFloat(3.14159f, 3, 4, 0);
+    goldenStr("  1000", 2, 0);
+    goldenStr(" -0.05", 3, 0);
+    goldenStr("3.142", 4, 0);
+    end("drawInt x1001 +fixed/float");
+
+    /* Longest numbers, out of range decimals */
+    begin();
+    OLED.drawInt(LONG_MIN, 5, 0);
+    OLED.drawFixed(5, 30, 6, 0, 16);
+    snprintf(text, sizeof(text), "%ld", LONG_MIN);
+    goldenStr(text, 5, 0);
+    goldenStr("     0.000000005", 6, 0);
+    end("drawInt/drawFixed limits");
+
+    /* Shrinking numbers blank the cells they no longer cover */
+    OLED.clear();
+    goldenClear();
+    begin();
+    OLED.drawInt(100, 0, 0);
+    OLED.drawInt(42, 1, 2, 3);
+    OLED.drawInt(99, 0, 0);
+    OLED.drawInt(-12345, 1, 2, 3);
+    OLED.drawInt(7, 1, 2, 3);
+    OLED.drawFloat(-1.5f, 1, 2, 0);
+    OLED.drawFloat(2.0f, 0, 2, 0);
+    goldenStr("99", 0, 0);
+    goldenStr("  7", 1, 2);
+    goldenStr("2", 2, 0);
+    end("drawInt/drawFloat shrinking");
+}
+
+
+static void benchSetPixel(const bool buffered) {
+    int col;
+
+    OLED.clear();
+    goldenClear();
+    OLED.setBuffered(buffered);
+    begin();
+    for (col = 0; col < 128; col++) {
+        int row = 32 + (col % 16 < 8 ? col % 8 : 8 - col % 8);
+        OLED.setPixel(row, col, true);
+        goldenPixel(row, col);
+    }
+    OLED.display();
+    OLED.setBuffered(false);
+    end(buffered ? "setPixel x128 (buffered)" : "setPixel x128");
+}
+
+
+static void benchAsync() {
+    int  polls = 0, i;
+    char name[40];
+
+    for (i = 0; i < (int)sizeof(image); i++) {
+        image[i] = (byte)(i * 13);
+    }
+
+    OLED.setAsync(true);
+    begin();
+    OLED.drawImage((const char *)image);
+    while (OLED.poll()) {
+        polls++;
+    }
+    OLED.setAsync(false);
+    memcpy(golden, image, sizeof(golden));
+    snprintf(name, sizeof(name), "drawImage async (%d polls)", polls + 1);
+    end(name);
+
+    /* Print::flush() drains what is queued */
+    OLED.setAsync(true);
+    OLED.clear();
+    OLED.print("flush");
+    begin();
+    OLED.flush();
+    OLED.setAsync(false);
+    goldenClear();
+    goldenStr("flush", 0, 0);
+    end("Print::flush() async", OLED_ADDRESS, !OLED.isFlushing());
+}
+
+
+static void benchPrimitives() {
+    OLED.clear();
+    goldenClear();
+    OLED.setBuffered(true);
+    begin();
+    OLED.drawRect(2, 3, 60, 20);
+    OLED.fillRect(4, 5, 37, 16);
+    OLED.fillRect(10, 10, 20, 4, OLED_INVERSE);
+    OLED.fillRect(10, 10, 20, 4, OLED_INVERSE);
+    OLED.drawLine(0, 40, 127, 40);
+    OLED.drawLine(70, 5, 70, 60);
+    OLED.fillCircle(100, 20, 12);
+    OLED.display();
+    OLED.setBuffered(false);
+
+    goldenFill(2, 3, 61, 3);
+    goldenFill(2, 22, 61, 22);
+    goldenFill(2, 3, 2, 22);
+    goldenFill(61, 3, 61, 22);
+    goldenFill(4, 5, 40, 20);
+    goldenFill(0, 40, 127, 40);
+    goldenFill(70, 5, 70, 60);
+    goldenDisc(100, 20, 12);
+    end("rect/line/circle (buffered)");
+}
+
+
+static void benchPixelModes() {
+    OLED.clear();
+    goldenClear();
+    OLED.setBuffered(true);
+    begin();
+    OLED.fillRect(0, 8, 16, 8);
+    OLED.setPixel(9, 3, false);
+    OLED.setPixel(10, 4, OLED_BLACK);
+    OLED.setPixel(11, 5, OLED_INVERSE);
+    OLED.setPixel(2, 6, OLED_INVERSE);
+    OLED.setPixel(3, 7, OLED_INVERSE);
+    OLED.setPixel(3, 7, OLED_INVERSE);
+    OLED.display();
+    OLED.setBuffered(false);
+
+    goldenFill(0, 8, 15, 15);
+    golden[1][3] &= ~(1 << 1);
+    golden[1][4] &= ~(1 << 2);
+    golden[1][5] &= ~(1 << 3);
+    goldenPixel(2, 6);
+    end("setPixel set/clear/xor");
+}
+
+
+/* Whole frame redrawn every tick, only a box moves */
+static void benchAnimation() {
+    int t;
+
+    OLED.clear();
+    OLED.setBuffered(true);
+    begin();
+    for (t = 0; t < 30; t++) {
+        OLED.clear();
+        OLED.drawStr("Redrawn frame", 0, 0);
+        OLED.drawProgressBar(7, 60);
+        OLED.fillRect(10 + 3*t, 24, 12, 12);
+#ifdef OLED_DOUBLE_BUFFER
+        OLED.swap();
+#else
+        OLED.display();
+#endif
+    }
+    goldenClear();
+    goldenStr("Redrawn frame", 0, 0);
+    goldenProgressBar(7, 60);
+    goldenFill(97, 24, 108, 35);
+#ifdef OLED_DOUBLE_BUFFER
+    end("redraw x30 (swap)");
+
+    /* A frame in flight is never mixed with the next one */
+    begin();
+    OLED.setAsync(true);
+    OLED.fillRect(0, 40, 128, 8);
+    bool ok = OLED.swap();
+    OLED.fillRect(0, 40, 128, 8, OLED_BLACK);
+    ok = ok && !OLED.swap();
+    while (OLED.poll());
+    ok = ok && OLED.swap();
+    while (OLED.poll());
+    OLED.setAsync(false);
+    end("swap() async", OLED_ADDRESS, ok);
+#else
+    end("redraw x30 (display)");
+#endif
+    OLED.setBuffered(false);
+}
+
+
+static void benchBitmap() {
+    static const int pos[][2] = { {37, 21}, {-5, -12}, {120, 59}, {3, 16} };
+    byte sprite[16*2];
+    int  i, rop;
+
+    for (i = 0; i < (int)sizeof(sprite); i++) {
+        sprite[i] = (byte)(i * 37 + 11);
+    }
+
+    OLED.clear();
+    goldenClear();
+    OLED.setBuffered(true);
+    begin();
+    OLED.fillRect(30, 10, 40, 30);
+    goldenFill(30, 10, 69, 39);
+    for (rop = OLED_ROP_COPY; rop <= OLED_ROP_ERASE; rop++) {
+        for (i = 0; i < 4; i++) {
+            OLED.drawBitmap(pos[i][0] + rop, pos[i][1] + rop, 16, 13,
+                            (const char *)sprite, rop);
+            goldenBitmap(pos[i][0] + rop, pos[i][1] + rop, 16, 13, sprite, rop);
+        }
+    }
+    OLED.display();
+    OLED.setBuffered(false);
+    end("drawBitmap x20 (all rops)");
+}
+
+
+static void benchBitmapRowMajor() {
+    static const int pos[][2] = { {37, 21}, {-5, -12}, {120, 59}, {3, 16} };
+    byte sprite[21*3], msb[19*3], lsb[19*3];
+    int  i, j, rop;
+
+    /* 21x19 sprite in both layouts, converted bit by bit */
+    memset(msb, 0, sizeof(msb));
+    memset(lsb, 0, sizeof(lsb));
+    for (i = 0; i < (int)sizeof(sprite); i++) {
+        sprite[i] = (byte)(i * 73 + 5);
+    }
+    for (j = 0; j < 19; j++) {
+        for (i = 0; i < 21; i++) {
+            if (!((sprite[(j/8)*21 + i] >> (j%8)) & 1)) continue;
+            msb[j*3 + i/8] |= 0x80 >> (i%8);
+            lsb[j*3 + i/8] |= 1 << (i%8);
+        }
+    }
+
+    OLED.clear();
+    goldenClear();
+    OLED.setBuffered(true);
+    begin();
+    OLED.fillRect(30, 10, 40, 30);
+    goldenFill(30, 10, 69, 39);
+    for (rop = OLED_ROP_COPY; rop <= OLED_ROP_ERASE; rop++) {
+        for (i = 0; i < 4; i++) {
+            OLED.drawBitmapRowMajor(pos[i][0] + rop, pos[i][1] + rop, 21, 19,
+                                    (const char *)((i & 1) ? lsb : msb), rop,
+                                    (i & 1) ? OLED_LSB_FIRST : OLED_MSB_FIRST);
+            goldenBitmap(pos[i][0] + rop, pos[i][1] + rop, 21, 19, sprite, rop);
+        }
+    }
+    OLED.display();
+    OLED.setBuffered(false);
+    end("drawBitmapRowMajor x20");
+}
+
+
+/* Same encoding as extras/tools/oledrle.cpp */
+static int rleEncode(const byte *in, const int len, byte *out) {
+    int i = 0, o = 0, run, lit;
+
+    while (i < len) {
+        for (run = 1; i + run < len && run < 128 && in[i + run] == in[i]; run++);
+        if (run >= 3) {
+            out[o++] = 0x80 | (run - 1);
+            out[o++] = in[i];
+            i += run;
+            continue;
+        }
+        for (lit = 0; i + lit < len && lit < 128; lit++) {
+            if (i + lit + 2 < len && in[i + lit] == in[i + lit + 1] &&
+                in[i + lit] == in[i + lit + 2]) break;
+        }
+        out[o++] = lit - 1;
+        memcpy(out + o, in + i, lit);
+        o += lit;
+        i += lit;
+    }
+    return o;
+}
+
+
+static void benchImageRLE() {
+    static byte rle[2*sizeof(image)];
+    char        name[40];
+    int         len;
+
+    /* Mostly blank UI screen */
+    goldenClear();
+    goldenFill(0, 0, 127, 9);
+    goldenStr("Status: OK", 3, 1);
+    goldenFill(10, 50, 117, 51);
+    len = rleEncode(&golden[0][0], sizeof(golden), rle);
+
+    OLED.clear();
+    begin();
+    OLED.drawImageRLE((const char *)rle);
+    snprintf(name, sizeof(name), "drawImageRLE (%d bytes)", len);
+    end(name);
+
+    goldenClear();
+    goldenBitmap(37, 13, 128, 16, &image[0], OLED_ROP_COPY);
+    len = rleEncode(&image[0], 2*128, rle);
+    OLED.clear();
+    begin();
+    OLED.drawBitmapRLE(37, 13, 128, 16, (const char *)rle);
+    end("drawBitmapRLE (clipped)");
+
+    /* Empty bitmap, nothing read from the stream */
+    begin();
+    OLED.drawBitmapRLE(0, 0, 0, 8, (const char *)rle);
+    OLED.drawBitmapRLE(0, 0, 8, 0, (const char *)rle);
+    end("drawBitmapRLE (empty)");
+}
+
+
+static OLED72x40 narrow72(0x3F);
+
+static void benchScroll() {
+    SimPanel *panel = Wire.panel(OLED_ADDRESS);
+    byte      row[128];
+    int       i;
+    bool      ok;
+
+    OLED.clear();
+    goldenClear();
+    goldenStr("<< marquee >>", 2, 1);
+    OLED.drawStr("<< marquee >>", 2, 1);
+
+    begin();
+    OLED.startScrollLeft(2, 2, OLED_SCROLL_2FRAMES);
+    ok = panel->scrolling && panel->scrollSetup[0] == OLED_LEFTSCROLL &&
+         Wire.stats.transactions == 1;
+    OLED.scrollBuffer(2, 2, -5);
+    OLED.stopScroll();
+    ok = ok && !panel->scrolling;
+
+    memcpy(row, golden[2], 128);
+    for (i = 0; i < 128; i++) {
+        golden[2][i] = row[(i + 5) % 128];
+    }
+    end("scroll start/stop+resync", OLED_ADDRESS, ok);
+
+    /* 72 of the 128 columns the engine rotates are visible, from column 28.
+     * Moved 100 columns right, column i shows column i + 28, and once
+     * mirrored the engine runs the other way along the buffer. */
+    narrow72.init();
+    narrow72.drawStr("<< marquee", 2, 0);
+    memcpy(row, &Wire.panel(0x3F)->ram[2][28], 72);
+    begin();
+    narrow72.scrollBuffer(2, 2, 100);
+    goldenClear();
+    for (i = 0; i < 72; i++) {
+        golden[2][28 + i] = (i < 44) ? row[i + 28] : 0;
+    }
+    ok = memcmp(Wire.panel(0x3F)->ram, golden, sizeof(golden)) == 0;
+
+    narrow72.clear();
+    narrow72.setMirror(true, false);
+    narrow72.drawStr("<< marquee", 2, 0);
+    narrow72.scrollBuffer(2, 2, 100);
+    for (i = 0; i < 72; i++) {
+        golden[2][28 + i] = (i >= 28) ? row[i - 28] : 0;
+    }
+    end("scrollBuffer on 72x40", 0x3F, ok);
+}
+
+
+static void benchConsole() {
+    static const uint16_t bad[] = { 'A', 0xFFFD, 'B', 0xFFFD, 'C', 0xFFFD,
+                                    'D' };
+    SimPanel *panel = Wire.panel(OLED_ADDRESS);
+    byte      logical[8][128];
+    char      line[16];
+    bool      ok;
+    int       i, polls;
+
+    OLED.clear();
+    for (i = 0; i < 8; i++) {
+        OLED.print("line ");
+        OLED.println(i);
+    }
+
+    begin();
+    for (; i < 12; i++) {
+        OLED.print("line ");
+        OLED.println(i);
+    }
+
+    /* Lines 5 to 11 on rows 0 to 6, GDDRAM rotated by 5 pages */
+    goldenClear();
+    for (i = 5; i < 12; i++) {
+        snprintf(line, sizeof(line), "line %d", i);
+        goldenStr(line, i - 5, 0);
+    }
+    memcpy(logical, golden, sizeof(golden));
+    for (i = 0; i < 8; i++) {
+        memcpy(golden[(i + 5) % 8], logical[i], 128);
+    }
+    end("console println x4 (scroll)", OLED_ADDRESS, panel->startLine == 40);
+
+    /* Buffered then asynchronous: the start line moves with the frame */
+    OLED.clear();
+    OLED.setBuffered(true);
+    begin();
+    for (i = 0; i < 9; i++) {
+        OLED.println(i);
+    }
+    ok = panel->startLine == 0;
+    OLED.display();
+    ok = ok && panel->startLine == 16;
+
+    OLED.setAsync(true);
+    OLED.println(9);
+    OLED.display();
+    ok = ok && panel->startLine == 16 && OLED.isFlushing();
+    for (polls = 0; OLED.isFlushing(); polls++) {
+        ok = ok && panel->startLine == 16;
+        OLED.poll(16);
+    }
+    ok = ok && panel->startLine == 24 && polls > 0;
+    OLED.setAsync(false);
+    OLED.setBuffered(false);
+
+    /* Lines 3 to 9 on rows 0 to 6, GDDRAM rotated by 3 pages */
+    goldenClear();
+    for (i = 3; i < 10; i++) {
+        snprintf(line, sizeof(line), "%d", i);
+        goldenStr(line, i - 3, 0);
+    }
+    memcpy(logical, golden, sizeof(golden));
+    for (i = 0; i < 8; i++) {
+        memcpy(golden[(i + 3) % 8], logical[i], 128);
+    }
+    end("console scroll (buffered)", OLED_ADDRESS, ok);
+
+    /* Malformed UTF-8 renders as drawStr() renders it */
+    OLED.clear();
+    goldenClear();
+    begin();
+    OLED.print("A\xF0\x90\x80\xB0" "B\x80" "C\xE2\x82" "D");
+    goldenGlyphs(bad, 7, 0, 0);
+    end("console (malformed UTF-8)");
+
+    OLED.clear();
+}
+
+
+static void benchSmallPanel() {
+    OLED128x32 small(0x3D);
+    byte       row[128];
+    int        i;
+
+    small.init();
+    goldenClear();
+    begin();
+    small.drawStr("128x32 panel", 3, 2);
+    goldenStr("128x32 panel", 3, 2);
+    end("drawStr on 128x32", 0x3D);
+
+    /* Pages past the panel are ignored */
+    begin();
+    small.scrollBuffer(0, 7, 1);
+    memcpy(row, golden[3], 128);
+    for (i = 0; i < 128; i++) {
+        golden[3][i] = row[(i + 127) % 128];
+    }
+    end("scrollBuffer on 128x32", 0x3D);
+}
+
+
+/* Draw rectangles at asymmetric places, on the screen and in a logical
+ * picture, then check the picture seen on the panel */
+static bool drawRotated(OLEDScreen &screen, SimPanel *panel, const int w,
+                        const int h, const int xoff, const int rot,
+                        const bool mx, const bool my,
+                        void (*fill)(int, int, int, int)) {
+    static bool logical[128][128];
+    const int   rects[][4] = { {0, 0, 1, 1}, {2, 3, 19, 7}, {5, 20, 3, 200},
+                               {-4, 40, 9, 5} };
+    int         lw = (rot & 1) ? h : w, lh = (rot & 1) ? w : h;
+    int         i, x, y, lx, ly;
+
+    memset(logical, 0, sizeof(logical));
+    for (i = 0; i < 4; i++) {
+        fill(rects[i][0], rects[i][1], rects[i][2], rects[i][3]);
+        for (y = rects[i][1]; y < rects[i][1] + rects[i][3]; y++) {
+            for (x = rects[i][0]; x < rects[i][0] + rects[i][2]; x++) {
+                if (x >= 0 && x < lw && y >= 0 && y < lh) logical[y][x] = true;
+            }
+        }
+    }
+    fill(lw - 3, lh - 2, 3, 2);
+    for (y = lh - 2; y < lh; y++) {
+        for (x = lw - 3; x < lw; x++) logical[y][x] = true;
+    }
+    screen.display();
+    while (screen.flushBudget(20));
+
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < w; x++) {
+            switch (rot) {
+                case OLED_ROTATE_0:   lx = x;         ly = y;         break;
+                case OLED_ROTATE_90:  lx = y;         ly = w - 1 - x; break;
+                case OLED_ROTATE_180: lx = w - 1 - x; ly = h - 1 - y; break;
+                default:              lx = h - 1 - y; ly = x;         break;
+            }
+            if (mx) lx = lw - 1 - lx;
+            if (my) ly = lh - 1 - ly;
+            if (panel->pixel(xoff + x, y) != logical[ly][lx]) return false;
+        }
+    }
+    return true;
+}
+
+
+static OLED64x48 narrow(0x3E);
+
+static void fillMain(int x, int y, int w, int h)   { OLED.fillRect(x, y, w, h); }
+static void fillNarrow(int x, int y, int w, int h) { narrow.fillRect(x, y, w, h); }
+
+
+static void benchRotation() {
+    SimPanel *panel = Wire.panel(OLED_ADDRESS);
+    bool      ok = true;
+    int       rot;
+
+    begin();
+    for (rot = OLED_ROTATE_0; rot <= OLED_ROTATE_270; rot++) {
+        OLED.setRotation(rot);
+        OLED.clear();
+        ok &= OLED.getWidth() == ((rot & 1) ? 64 : 128);
+        ok &= drawRotated(OLED, panel, 128, 64, 0, rot, false, false, fillMain);
+
+        /* Partial flushes of whole frames */
+        OLED.setAsync(true);
+        OLED.clear();
+        while (OLED.poll(20));
+        OLED.setMirror(true, rot & 1);
+        while (OLED.poll(20));
+        ok &= drawRotated(OLED, panel, 128, 64, 0, rot, true, rot & 1, fillMain);
+        OLED.setAsync(false);
+        OLED.setMirror(false, false);
+    }
+
+    narrow.init();
+    for (rot = OLED_ROTATE_90; rot <= OLED_ROTATE_180; rot++) {
+        narrow.setRotation(rot);
+        narrow.clear();
+        ok &= drawRotated(narrow, Wire.panel(0x3E), 64, 48, 32, rot, false,
+                          false, fillNarrow);
+    }
+
+    OLED.setRotation(OLED_ROTATE_0);
+    OLED.clear();
+    goldenClear();
+    end("setRotation x4 + mirror", OLED_ADDRESS, ok);
+}
+
+
+/* Screen content lost on init() or rotation is sent again whole, even
+ * where the buffer ends up as it was (double buffering) */
+static void benchReinit() {
+    OLED.fillRect(0, 0, 128, 8);
+    begin();
+    OLED.init();
+    goldenClear();
+    end("init again (lit page)");
+
+    OLED.fillRect(0, 0, 128, 8);
+    begin();
+    OLED.setRotation(OLED_ROTATE_90);
+    end("setRotation 90 (lit page)");
+    OLED.setRotation(OLED_ROTATE_0);
+}
+
+
+static void benchManager() {
+    static TwoWire wire2;
+    OLED128x32     small(0x3D);
+    OLED128x64     other(OLEDI2C(OLED_ADDRESS, wire2));
+    OLEDManager    manager;
+    unsigned long  bytes, peak = 0;
+    int            polls = 0, smallPolls = 0;
+    char           name[40];
+    bool           ok;
+
+    small.init();
+    other.init();
+    OLED.clear();
+    manager.add(OLED);
+    manager.add(small);
+    manager.add(other);
+
+    /* Two full frames and a 96 bytes line, sharing Wire with one frame: the
+     * line gets half of the budget and is sent within 3 polls */
+    OLED.drawImage((const char *)image);
+    small.drawStr("second panel", 1, 0);
+    other.drawImage((const char *)image);
+    begin();
+    wire2.resetStats();
+    do {
+        bytes = Wire.stats.dataBytes;
+        manager.poll(64);
+        if (Wire.stats.dataBytes - bytes > peak) {
+            peak = Wire.stats.dataBytes - bytes;
+        }
+        polls++;
+        if (small.isFlushing()) smallPolls = polls + 1;
+    } while (manager.isFlushing());
+
+    goldenClear();
+    goldenStr("second panel", 1, 0);
+    ok = memcmp(Wire.panel(0x3D)->ram, golden, 4*128) == 0 &&
+         memcmp(wire2.panel(OLED_ADDRESS)->ram, image, sizeof(image)) == 0 &&
+         peak <= 64 && smallPolls <= 3;
+    memcpy(golden, image, sizeof(golden));
+    snprintf(name, sizeof(name), "manager x3 (%d polls)", polls);
+    end(name, OLED_ADDRESS, ok);
+
+    OLED.setAsync(false);
+}
+
+
+/* Bytes and last address seen by a DMA hook */
+struct DmaLog {
+    int  bytes;
+    byte address;
+};
+
+
+static void i2cDmaHook(void *context, const byte address, const byte *data,
+                       const int len) {
+    DmaLog *log = (DmaLog *)context;
+
+    log->bytes  += len;
+    log->address = address;
+    Wire.beginTransmission(address);
+    Wire.write(data, len);
+    Wire.endTransmission();
+}
+
+
+static void spiDmaHook(void *context, const byte, const byte *data,
+                       const int len) {
+    DmaLog *log = (DmaLog *)context;
+    int     i;
+
+    log->bytes += len;
+    for (i = 0; i < len; i++) {
+        SPI.transfer(data[i]);
+    }
+}
+
+
+static void benchDmaHook() {
+    DmaLog log = {0, 0};
+
+    OLED.clear();
+    OLED.setDmaHook(i2cDmaHook, &log);
+    begin();
+    OLED.drawImage((const char *)image);
+    memcpy(golden, image, sizeof(golden));
+    end("drawImage (DMA hook)", OLED_ADDRESS,
+        log.bytes == (int)Wire.stats.bytes && log.address == OLED_ADDRESS);
+    OLED.setDmaHook(NULL);
+}
+
+
+static void benchSpi() {
+    OLEDSPI       bus(9, 10);
+    OLED128x64SPI spiOled(bus);
+    DmaLog        log = {0, 0};
+    bool          ok;
+    int           pass;
+
+    printf("\n%-28s %7s %7s %9s %9s %9s\n", "SPI workload", "trans", "bytes",
+           "1M ms", "4M ms", "8M ms");
+
+    SPI.attach(9, 10);
+    spiOled.init();
+    for (pass = 0; pass < 2; pass++) {
+        if (pass) {
+            spiOled.setDmaHook(spiDmaHook, &log);
+            spiOled.clear();
+        }
+        SPI.resetStats();
+        log.bytes = 0;
+        spiOled.drawImage((const char *)image);
+
+        ok = memcmp(SPI.panel.ram, image, sizeof(SPI.panel.ram)) == 0 &&
+             (!pass || log.bytes == (int)SPI.stats.dataBytes);
+        if (!ok) failures++;
+
+        printf("%-28s %7lu %7lu %9.2f %9.2f %9.2f  %s\n",
+               pass ? "drawImage (DMA hook)" : "drawImage",
+               SPI.stats.transactions, SPI.stats.bytes,
+               SPI.busMicros(1000000) / 1000.0, SPI.busMicros(4000000) / 1000.0,
+               SPI.busMicros(8000000) / 1000.0, ok ? "ok" : "MISMATCH");
+    }
+}
+
+
+#ifdef OLED_STATS
+static void benchStats() {
+    static const char *names[OLED_STAT_COUNT] = {
+        "init", "display", "clear", "pixel", "str", "number", "image",
+        "bitmap", "shape", "widget", "console", "scroll"
+    };
+    int i;
+
+    OLED.clear();
+    goldenClear();
+    OLED.resetStats();
+    begin();
+    OLED.drawStr("stats", 0, 0);
+    for (i = 0; i < 100; i++) {
+        OLED.drawInt(i, 1, 0, 4);
+    }
+    OLED.fillCircle(64, 40, 10);
+    goldenStr("stats", 0, 0);
+    goldenStr("  99", 1, 0);
+    goldenDisc(64, 40, 10);
+
+    const OLEDStats &st = OLED.getStats();
+    end("getStats() matches bus", OLED_ADDRESS,
+        st.transactions == Wire.stats.transactions &&
+        st.cmdBytes == Wire.stats.cmdBytes &&
+        st.dataBytes == Wire.stats.dataBytes);
+
+    printf("\n%-10s %7s %10s   (skipped %lu bytes)\n", "op", "calls", "us",
+           st.skippedBytes);
+    for (i = 0; i < OLED_STAT_COUNT; i++) {
+        if (st.calls[i]) {
+            printf("%-10s %7lu %10lu\n", names[i], st.calls[i], st.micros[i]);
+        }
+    }
+}
+#endif
+
+
+int main() {
+    printf("%-28s %7s %7s %9s %9s %9s\n", "workload", "trans", "bytes",
+           "100k ms", "400k ms", "1M ms");
+
+    benchInit();
+    benchClear();
+    benchDrawStr();
+    benchUtf8();
+    benchDrawImage();
+    benchGray();
+    benchProgressBar();
+    benchText();
+    benchWidgets();
+    benchNumbers();
+    benchSetPixel(false);
+    benchSetPixel(true);
+    benchAsync();
+    benchPrimitives();
+    benchPixelModes();
+    benchAnimation();
+    benchBitmap();
+    benchBitmapRowMajor();
+    benchImageRLE();
+    benchScroll();
+    benchConsole();
+    benchSmallPanel();
+    benchManager();
+    benchRotation();
+    benchReinit();
+    benchDmaHook();
+    benchSpi();
+#ifdef OLED_STATS
+    benchStats();
+#endif
+
+    if (failures) {
+        printf("%d workload(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
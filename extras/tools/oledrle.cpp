@@ -0,0 +1,156 @@
+/*******************************************************************************
+* Copyright (C) 2015, Jean-Yves VET, contact [at] jean-yves [dot] vet          *
+*                                                                              *
+* This software is licensed as described in the file LICENCE, which you should *
+* have received as part of this distribution. You may opt to use, copy,        *
+* modify, merge, publish, distribute and/or sell copies of the Software, and   *
+* permit persons to whom the Software is furnished to do so, under the terms   *
+* of the LICENCE file.                                                         *
+*                                                                              *
+* This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY    *
+* KIND, either express or implied.                                             *
+*******************************************************************************/
+
+/**
+ * @file oledrle.cpp
+ * @brief Host-side encoder for drawImageRLE()/drawBitmapRLE().
+ *
+ * Reads a C array holding an image in the drawImage() format on stdin and
+ * writes the run-length encoded PROGMEM array on stdout. The optional byte
+ * count (1024 for a 128x64 image) is checked against the array:
+ *
+ *     g++ -o oledrle extras/tools/oledrle.cpp
+ *     ./oledrle splash 1024 < splash.h > splash_rle.h
+ *
+ * @author Jean-Yves VET
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <vector>
+
+
+/**
+ * Skip a comment or an identifier, which may hold digits that are not
+ * part of the array.
+ *
+ * @param  p        Current position
+ * @return Position after the comment or identifier, p if there is none
+ */
+static const char *skip(const char *p) {
+    if (p[0] == '/' && p[1] == '*') {
+        for (p += 2; *p && !(p[0] == '*' && p[1] == '/'); p++);
+        return *p ? p + 2 : p;
+    }
+    if (p[0] == '/' && p[1] == '/') {
+        for (p += 2; *p && *p != '\n'; p++);
+        return p;
+    }
+    if (isalpha((unsigned char)*p) || *p == '_') {
+        for (p++; isalnum((unsigned char)*p) || *p == '_'; p++);
+    }
+    return p;
+}
+
+
+/**
+ * Parse the numbers of the first array, nested braces included.
+ *
+ * @param  in       Input stream
+ * @param  out      Parsed bytes
+ * @return false if no complete array was found
+ */
+static bool parse(FILE *in, std::vector<unsigned char> &out) {
+    std::vector<char> text;
+    char              buf[4096];
+    size_t            n;
+    const char       *p, *end;
+    int               depth = 0;
+
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        text.insert(text.end(), buf, buf + n);
+    }
+    text.push_back('\0');
+
+    for (p = &text[0]; *p; ) {
+        end = skip(p);
+        if (end != p) {
+            p = end;
+        } else if (*p == '{') {
+            depth++;
+            p++;
+        } else if (*p == '}') {
+            if (--depth == 0) return true;
+            p++;
+        } else if (depth > 0 && isdigit((unsigned char)*p)) {
+            out.push_back((unsigned char)strtol(p, (char **)&end, 0));
+            p = end;
+        } else {
+            p++;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * Encode bytes: runs of 3 or more identical bytes become repeat tokens,
+ * everything else literal tokens (at most 128 bytes per token).
+ *
+ * @param  in       Raw bytes
+ * @param  out      Encoded bytes
+ */
+static void encode(const std::vector<unsigned char> &in,
+                   std::vector<unsigned char> &out) {
+    size_t i = 0, run, lit;
+
+    while (i < in.size()) {
+        for (run = 1; i + run < in.size() && run < 128 &&
+                      in[i + run] == in[i]; run++);
+
+        if (run >= 3) {
+            out.push_back(0x80 | (run - 1));
+            out.push_back(in[i]);
+            i += run;
+            continue;
+        }
+
+        /* Literal bytes up to the next run of 3 */
+        for (lit = 0; i + lit < in.size() && lit < 128; lit++) {
+            if (i + lit + 2 < in.size() && in[i + lit] == in[i + lit + 1] &&
+                in[i + lit] == in[i + lit + 2]) break;
+        }
+        out.push_back(lit - 1);
+        out.insert(out.end(), in.begin() + i, in.begin() + i + lit);
+        i += lit;
+    }
+}
+
+
+int main(int argc, char **argv) {
+    std::vector<unsigned char> raw, rle;
+    const char                *name = (argc > 1) ? argv[1] : "image";
+    long                       size = (argc > 2) ? atol(argv[2]) : 0;
+    size_t                     i;
+
+    if (!parse(stdin, raw) || raw.empty()) {
+        fprintf(stderr, "oledrle: no C array found on stdin\n");
+        return 1;
+    }
+    if (size > 0 && raw.size() != (size_t)size) {
+        fprintf(stderr, "oledrle: %u bytes found, %ld expected\n",
+                (unsigned)raw.size(), size);
+        return 1;
+    }
+    encode(raw, rle);
+
+    printf("/* %u bytes encoded to %u bytes */\n",
+           (unsigned)raw.size(), (unsigned)rle.size());
+    printf("const char %s[] PROGMEM = {", name);
+    for (i = 0; i < rle.size(); i++) {
+        printf("%s0x%02x", i ? (i % 12 ? ", " : ",\n    ") : "\n    ", rle[i]);
+    }
+    printf("\n};\n");
+    return 0;
+}